@@ -0,0 +1,144 @@
+#include "BitBoard.hh"
+#include "Magic.hh"
+
+uint64_t Chess::BitBoard::shift(uint64_t bits, const Vec2i& direction)
+{
+	//	Files that would wrap around to the other side of the board are removed
+	const uint64_t file = 0x0101010101010101ULL;
+
+	for(int x = 0; x < direction.x; x++) bits &= ~(file << (7 - x));
+	for(int x = 0; x < -direction.x; x++) bits &= ~(file << x);
+
+	//	Ranks that go past the edge are shifted out of the integer
+	int amount = direction.x + direction.y * 8;
+	return amount >= 0 ? bits << amount : bits >> -amount;
+}
+
+uint64_t Chess::BitBoard::slide(uint64_t bits, const Vec2i& direction, uint64_t empty)
+{
+	uint64_t result = 0;
+
+	//	Keep going until each ray hits an edge or a piece. The blocking piece is included
+	for(bits = shift(bits, direction); bits; bits = shift(bits & empty, direction))
+		result |= bits;
+
+	return result;
+}
+
+uint64_t Chess::BitBoard::knightAttacks(uint64_t bits)
+{
+	return	shift(bits, Vec2i(-1, -2)) | shift(bits, Vec2i(1, -2)) |
+			shift(bits, Vec2i(2, -1)) | shift(bits, Vec2i(2, 1)) |
+			shift(bits, Vec2i(1, 2)) | shift(bits, Vec2i(-1, 2)) |
+			shift(bits, Vec2i(-2, -1)) | shift(bits, Vec2i(-2, 1));
+}
+
+uint64_t Chess::BitBoard::kingAttacks(uint64_t bits)
+{
+	//	Spread the pieces sideways first and then up and down
+	uint64_t row = bits | shift(bits, Vec2i(-1, 0)) | shift(bits, Vec2i(1, 0));
+	return (row | shift(row, Vec2i(0, -1)) | shift(row, Vec2i(0, 1))) & ~bits;
+}
+
+uint64_t Chess::BitBoard::straightAttacks(uint64_t bits, uint64_t empty)
+{
+	return	slide(bits, Vec2i(-1, 0), empty) | slide(bits, Vec2i(1, 0), empty) |
+			slide(bits, Vec2i(0, -1), empty) | slide(bits, Vec2i(0, 1), empty);
+}
+
+uint64_t Chess::BitBoard::slantAttacks(uint64_t bits, uint64_t empty)
+{
+	return	slide(bits, Vec2i(-1, -1), empty) | slide(bits, Vec2i(1, -1), empty) |
+			slide(bits, Vec2i(-1, 1), empty) | slide(bits, Vec2i(1, 1), empty);
+}
+
+void Chess::BitBoard::clear()
+{
+	for(auto& p : pieces) p = 0;
+	for(auto& p : players) p = 0;
+}
+
+void Chess::BitBoard::set(const Vec2s& position, const Tile& old, const Tile& tile)
+{
+	uint64_t b = bit(position);
+
+	if(old.piece != PieceName::None)
+	{
+		pieces[static_cast <size_t> (old.piece)] &= ~b;
+		players[old.playerID] &= ~b;
+	}
+
+	if(tile.piece != PieceName::None)
+	{
+		pieces[static_cast <size_t> (tile.piece)] |= b;
+		players[tile.playerID] |= b;
+	}
+}
+
+uint64_t Chess::BitBoard::pawnAttacks(uint64_t bits, size_t playerID) const
+{
+	return shift(bits, pawnCaptures[playerID][0]) | shift(bits, pawnCaptures[playerID][1]);
+}
+
+uint64_t Chess::BitBoard::attacks(PieceName piece, size_t playerID, uint64_t bits) const
+{
+	//	Sliding pieces are looked up from tables
+	unsigned tile = __builtin_ctzll(bits);
+
+	switch(piece)
+	{
+		case PieceName::Pawn: return pawnAttacks(bits, playerID);
+		case PieceName::Knight: return knightAttacks(bits);
+		case PieceName::King: return kingAttacks(bits);
+		case PieceName::Rook: return Magic::rookAttacks(tile, occupied());
+		case PieceName::Bishop: return Magic::bishopAttacks(tile, occupied());
+		case PieceName::Queen: return Magic::rookAttacks(tile, occupied()) | Magic::bishopAttacks(tile, occupied());
+		case PieceName::None: return 0;
+	}
+
+	return 0;
+}
+
+bool Chess::BitBoard::attacked(const Vec2s& position, size_t byPlayer) const
+{
+	uint64_t b = bit(position);
+	unsigned tile = position.y * 8 + position.x;
+	uint64_t enemy = players[byPlayer];
+
+	/*	Pretend that the tile has each kind of a piece. If it could capture
+	 *	an enemy piece of the same kind, that piece attacks this tile */
+	uint64_t straight = pieces[static_cast <size_t> (PieceName::Rook)] | pieces[static_cast <size_t> (PieceName::Queen)];
+	uint64_t slant = pieces[static_cast <size_t> (PieceName::Bishop)] | pieces[static_cast <size_t> (PieceName::Queen)];
+
+	//	Enemy pawns attack this tile if a pawn could move backwards diagonally from here to them
+	uint64_t pawns = shift(b, pawnCaptures[byPlayer][0] * -1) | shift(b, pawnCaptures[byPlayer][1] * -1);
+
+	return	((pawns & pieces[static_cast <size_t> (PieceName::Pawn)]) |
+			(knightAttacks(b) & pieces[static_cast <size_t> (PieceName::Knight)]) |
+			(kingAttacks(b) & pieces[static_cast <size_t> (PieceName::King)]) |
+			(Magic::rookAttacks(tile, occupied()) & straight) |
+			(Magic::bishopAttacks(tile, occupied()) & slant)) & enemy;
+}
+
+size_t Chess::BitBoard::mobility(size_t playerID) const
+{
+	uint64_t own = players[playerID];
+	uint64_t pawns = pieces[static_cast <size_t> (PieceName::Pawn)] & own;
+
+	//	Pawns can move forward to empty tiles and capture diagonally
+	size_t result =	__builtin_popcountll(shift(pawns, pawnDirection[playerID]) & ~occupied()) +
+					__builtin_popcountll(shift(pawns, pawnCaptures[playerID][0]) & players[!playerID]) +
+					__builtin_popcountll(shift(pawns, pawnCaptures[playerID][1]) & players[!playerID]);
+
+	//	Pawns are handled above so start from the piece after pawns
+	for(size_t piece = static_cast <size_t> (PieceName::Pawn) + 1; piece < 7; piece++)
+	{
+		for(uint64_t bits = pieces[piece] & own; bits; bits &= bits - 1)
+		{
+			uint64_t b = bits & -bits;
+			result += __builtin_popcountll(attacks(static_cast <PieceName> (piece), playerID, b) & ~own);
+		}
+	}
+
+	return result;
+}
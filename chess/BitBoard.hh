@@ -0,0 +1,53 @@
+#ifndef CHESS_BITBOARD_HEADER
+#define CHESS_BITBOARD_HEADER
+
+#include "../Vector2.hh"
+#include "Piece.hh"
+
+#include <cstdint>
+
+namespace Chess
+{
+
+/*	BitBoard is an alternative board representation for 8x8 games with two
+ *	players. Each piece type and each player has a 64-bit occupancy mask where
+ *	bit y * 8 + x represents the tile at (x, y) */
+struct BitBoard
+{
+	static uint64_t bit(const Vec2s& position) { return 1ULL << (position.y * 8 + position.x); }
+	static Vec2s position(unsigned index) { return Vec2s(index & 7, index >> 3); }
+
+	static uint64_t shift(uint64_t bits, const Vec2i& direction);
+	static uint64_t slide(uint64_t bits, const Vec2i& direction, uint64_t empty);
+
+	static uint64_t knightAttacks(uint64_t bits);
+	static uint64_t kingAttacks(uint64_t bits);
+	static uint64_t straightAttacks(uint64_t bits, uint64_t empty);
+	static uint64_t slantAttacks(uint64_t bits, uint64_t empty);
+
+	void clear();
+	void set(const Vec2s& position, const Tile& old, const Tile& tile);
+
+	uint64_t occupied() const { return players[0] | players[1]; }
+	uint64_t pawnAttacks(uint64_t bits, size_t playerID) const;
+
+	//	Which tiles can the given piece attack. bits should only have the bit of that piece set
+	uint64_t attacks(PieceName piece, size_t playerID, uint64_t bits) const;
+
+	//	Is the given tile attacked by a piece of the given player
+	bool attacked(const Vec2s& position, size_t byPlayer) const;
+
+	//	How many tiles the pieces of the given player could move to
+	size_t mobility(size_t playerID) const;
+
+	uint64_t pieces[7];
+	uint64_t players[2];
+
+	//	Pawns move towards pawnDirection and capture diagonally towards pawnCaptures
+	Vec2i pawnDirection[2];
+	Vec2i pawnCaptures[2][2];
+};
+
+}
+
+#endif
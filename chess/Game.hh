@@ -2,50 +2,59 @@
 #define CHESS_GAME_HEADER
 
 #include "../Vector2.hh"
+#include "Position.hh"
 #include "Player.hh"
+#include "Piece.hh"
+#include "Move.hh"
+#include "Search.hh"
 
 #include <functional>
+#include <string>
 #include <cstddef>
 #include <vector>
+#include <memory>
 
 namespace Chess
 {
 
-enum class PieceName
+class Game
 {
-	None,
-	Pawn,
-	Bishop,
-	Knight,
-	Rook,
-	Queen,
-	King
-};
+public:
+	typedef Position::Undo Undo;
 
-enum class MoveType
-{
-	Move,
-	Capture
-};
+	//	The board can be at most 16x16. Larger sizes throw std::invalid_argument
+	Game(size_t boardWidth, size_t boardHeight);
 
-struct Tile
-{
-	Tile(PieceName piece, size_t id) : piece(piece), playerID(id) {}
+	/*	fromFEN() replaces the game with the one described by the given FEN
+	 *	string or the extended notation of Position. Returns false if the
+	 *	string is malformed in which case the game is in an unknown state */
+	bool fromFEN(const char* fen);
 
-	PieceName piece;
-	size_t playerID;
-};
+	//	toFEN() returns the current position in the notation that fromFEN() reads
+	size_t toFEN(char* buffer, size_t size) { return position.toFEN(buffer, size); }
+	std::string toFEN();
 
-class Game
-{
-public:
-	Game(size_t boardWidth, size_t boardHeight);
-	const Player& addPlayer(const Vec2s& kingPosition, const Vec2s& middle, bool isBot);
+	//	Returns nullptr if the game already has MoveTables::maxPlayers players
+	const Player* addPlayer(const Vec2s& kingPosition, const Vec2s& middle, bool isBot);
+
+	//	Players read from a FEN aren't bots until they're made ones with this
+	void setBot(size_t playerID, bool isBot);
 
 	Tile at(size_t x, size_t y);
-	size_t getCurrentTurn() { return currentPlayer; }
-	Vec2s getBoardSize() { return mainBoard.size; }
-	Vec2s getPromotion() { return mainBoard.promotionAt; }
+	size_t getCurrentTurn() { return position.getCurrentTurn(); }
+	size_t getPlayerCount() { return position.getPlayerCount(); }
+	const Player& getPlayer(size_t playerID) { return position.getPlayer(playerID); }
+	Vec2s getBoardSize() { return position.getBoardSize(); }
+	Vec2s getPromotion() { return position.getPromotion(); }
+
+	/*	snapshot() returns a copy of the current position. The copy is a single
+	 *	memcpy so it's cheap to hand to readers on other threads */
+	Position snapshot() const { return position; }
+
+	/*	hash() returns the Zobrist hash of the current position. It covers the
+	 *	pieces, castling rights, pawns that can be captured en passant and the
+	 *	player whose turn it is */
+	uint64_t hash() { return position.hash(); }
 
 	/*	move() moves whatever is at tile "from" to tile
 	 *	"to". It does not check if the given piece should move.
@@ -54,54 +63,85 @@ public:
 
 	void promote(PieceName newPiece);
 
+	/*	takeBack() reverts the last move made with move(), promote() or makeMove().
+	 *	Returns false if there are no moves to take back */
+	bool takeBack();
+
+	/*	makeMove() applies a move generated by legalMoves() and stores what's
+	 *	needed to revert it with unmakeMove(). Moves have to be reverted in the
+	 *	reverse order. Unlike move(), this doesn't update checks */
+	void makeMove(const Move& move, Undo& undo);
+	void unmakeMove(const Undo& undo);
+
 	void getChecks(const std::function <void(Vec2s)>& callback);
-	void legalMoves(Vec2s position, const std::function <void(Vec2s, MoveType)>& callback,
-					bool protectKing = true);
 
-private:
-	struct Board
-	{
-		bool occupied(const Vec2s& position);
-		bool isInside(const Vec2s& position);
+	//	Is the king of the given player threatened in the current position
+	bool inCheck(size_t playerID);
+
+	/*	status() tells if the current player is checkmated or stalemated. The
+	 *	result is computed when it's first needed after the position changes */
+	Status status();
 
-		Tile& at(const Vec2s& position);
-		std::vector <Tile> data;
+	/*	playBots() lets bots move until it's the turn of a player that isn't a bot.
+	 *	move() and promote() don't call this, so call it after them when the next
+	 *	player may be a bot. Each bot move is a search that blocks the caller for
+	 *	as long as the bot limits allow, 1 second by default, so event loops should
+	 *	call it on another thread. If every player is a bot, only one move is made */
+	void playBots();
 
-		bool waitForPromotion = false;
-		Vec2s promotionAt;
+	//	How long each bot move may take. See playBots()
+	void setBotLimits(const SearchLimits& limits) { botLimits = limits; }
 
-		Vec2s size;
-	};
+	//	What the search of the last bot move found and how fast it was
+	const SearchResult& getBotReport() { return botReport; }
 
-	struct HistoryEntry
-	{
-		HistoryEntry(Vec2s from, Vec2s to, Tile change)
-			: from(from), to(to), change(change) {}
+	//	How many tiles the pieces of the given player could move to
+	size_t mobility(size_t playerID);
 
-		Vec2s from;
-		Vec2s to;
+	//	The material and piece-square score of the given player. See Position::pieceScore()
+	int pieceScore(size_t playerID) { return position.pieceScore(playerID); }
 
-		Tile change;
-	};
+	/*	setNetwork() makes bots and Search evaluate positions with the given network
+	 *	instead of pieceScore(). The network has to outlive the game. nullptr stops that */
+	void setNetwork(const Network* network) { position.setNetwork(network); }
+	const Network* getNetwork() { return position.getNetwork(); }
+	int networkScore(size_t playerID) { return position.networkScore(playerID); }
 
-	void createPlayer(Vec2s kingPosition, Vec2s middle);
-	void flagThreatenedKings(Board& board, bool countLegalMoves);
-	bool leadsToCheck(Board& board, Vec2s from, Vec2s to);
+	//	legalMoves() appends the moves of the piece at the given position to the list
+	void legalMoves(Vec2s position, MoveList& list, bool protectKing = true);
+
+	/*	generateAllMoves() appends the moves of every piece of the current player to
+	 *	the list. This is faster than calling legalMoves() for each piece */
+	void generateAllMoves(MoveList& list, bool protectKing = true);
+
+	//	countLegalMoves() returns how many moves generateAllMoves() would give
+	size_t countLegalMoves();
+
+	/*	Calls the given callback for each tile that the given piece can move to.
+	 *	This is a thin wrapper around the MoveList variant of legalMoves() */
+	void legalMoves(Vec2s position, const std::function <void(Vec2s, MoveType)>& callback,
+					bool protectKing = true);
+
+private:
+	//	How many moves fit in the history before it has to grow
+	static const size_t historyReserve = 256;
 
-	bool canCastle(Board& board, Player& player, Vec2s& position, bool queenSide);
-	bool canEnPassante(Board& board, Player& player, Vec2s& position, Vec2i direction);
+	void reset(size_t boardWidth, size_t boardHeight);
 
-	void legalMoves(Board& board, Vec2s position, bool protectKing,
-					const std::function <void(Vec2s, MoveType)>& callback);
+	Position position;
 
-	void move(Board& board, const Vec2s& from, Vec2s to);
-	void promote(Board& board, PieceName newPiece);
+	//	Each move is stored with what's needed to take it back
+	std::vector <Undo> moveHistory;
 
-	std::vector <Player> players;
-	std::vector <HistoryEntry> moveHistory;
+	//	status() is cached until the hash changes
+	Status cachedStatus = Status::Playing;
+	uint64_t statusHash = 0;
+	bool statusValid = false;
 
-	size_t currentPlayer = 0;
-	Board mainBoard;
+	//	Copies of a game share the table of the bots
+	std::shared_ptr <TranspositionTable> botTable;
+	SearchLimits botLimits;
+	SearchResult botReport;
 };
  
 }
@@ -0,0 +1,108 @@
+#include "Magic.hh"
+#include "BitBoard.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+__attribute__((target("bmi2")))
+uint64_t Chess::Magic::parallelExtract(uint64_t bits, uint64_t mask)
+{
+	return _pext_u64(bits, mask);
+}
+
+static bool hasPext()
+{
+	return __builtin_cpu_supports("bmi2");
+}
+
+#else
+
+uint64_t Chess::Magic::parallelExtract(uint64_t, uint64_t) { return 0; }
+static bool hasPext() { return false; }
+
+#endif
+
+/*	Magic numbers that map every blocker configuration of each tile to a table
+ *	index without harmful collisions. They were found by trying sparse random
+ *	numbers until one worked, which is too slow to do every time at startup */
+static const uint64_t rookMagics[64]
+{
+	0xA080001820400080ULL, 0x0040002000401000ULL, 0x0180300160008008ULL, 0x0480040800801001ULL,
+	0x2A00081084204200ULL, 0x0480018012003400ULL, 0x0600010082000428ULL, 0x420002250C018042ULL,
+	0x0040800040002080ULL, 0x000040002000500CULL, 0x2002004022001080ULL, 0x0026002200400810ULL,
+	0x2000808008000400ULL, 0x0022000200883104ULL, 0x2C88808001000200ULL, 0x1112000080420104ULL,
+	0x0100908000400020ULL, 0x0080808020004000ULL, 0x0008410010200300ULL, 0x0014808010000801ULL,
+	0x0080050011004800ULL, 0x00D1010002080400ULL, 0xA08004000A300158ULL, 0x1000120005288244ULL,
+	0x020C400080248002ULL, 0x4020411200220082ULL, 0x8028100080200881ULL, 0x1210001100090020ULL,
+	0x005A005200084520ULL, 0x0080040080020080ULL, 0x0002000200840148ULL, 0x440B210A00006884ULL,
+	0x0880401028800080ULL, 0x2000802008804000ULL, 0x2160001041002900ULL, 0x201020400A001200ULL,
+	0x8018010009001104ULL, 0x2480800400800200ULL, 0x0000010804000210ULL, 0x0020008042003104ULL,
+	0x0000802040008000ULL, 0x0010002000404000ULL, 0x0001001020010041ULL, 0x8840100009010022ULL,
+	0x8048004020040400ULL, 0x2000040002008080ULL, 0x0803000200010084ULL, 0x0010004400820001ULL,
+	0xA881410720800100ULL, 0x0008208A00450600ULL, 0x0000802000100080ULL, 0x004408A240920200ULL,
+	0x6000800400080080ULL, 0x0020040002008080ULL, 0x8003000A00245500ULL, 0x0100842081004200ULL,
+	0x0000201840820102ULL, 0x0011002040008019ULL, 0x001181C20020501AULL, 0x1C10014488201101ULL,
+	0x0002002004110802ULL, 0x0881000204000801ULL, 0x2000880142100094ULL, 0x000154050022C082ULL
+};
+
+static const uint64_t bishopMagics[64]
+{
+	0x0008220808002284ULL, 0x0004818801010100ULL, 0x4010010861020010ULL, 0x0091041080010000ULL,
+	0x0901104080008808ULL, 0x020208020A004020ULL, 0x8000410808400000ULL, 0x1102018401093000ULL,
+	0x0008409004810040ULL, 0x42004808C8088020ULL, 0x0200462802108000ULL, 0x1429110414800002ULL,
+	0x00806A1210042020ULL, 0x0801011002111010ULL, 0x48002A0804048406ULL, 0x0104C23088041000ULL,
+	0x0504840AA0082200ULL, 0x0108181218014411ULL, 0x0001100800440080ULL, 0x2020840812004020ULL,
+	0x0001022820080040ULL, 0x020E010022100200ULL, 0x0454040202322254ULL, 0x040A511023041001ULL,
+	0x0120100049024800ULL, 0x8A01100008104108ULL, 0x2290444010110200ULL, 0x2902080004004108ULL,
+	0x4002002002008044ULL, 0x104E041006004214ULL, 0x3082320100480201ULL, 0x000C104C40221200ULL,
+	0x8202382402222008ULL, 0x2001180230081080ULL, 0x0004004408880030ULL, 0x10841C0401880210ULL,
+	0x0000408020420200ULL, 0x0010100C41008044ULL, 0x0024014200044802ULL, 0x8400811440110400ULL,
+	0xD002021040040480ULL, 0x608A220220808200ULL, 0x4802020224000A00ULL, 0x1008204200800801ULL,
+	0x880020020C000081ULL, 0x001002080240080CULL, 0x4020010111000200ULL, 0x005282040B080020ULL,
+	0x8804042402080401ULL, 0x001020880808084CULL, 0x8000020100881200ULL, 0x0818000220882803ULL,
+	0x0100001202020000ULL, 0x00A220A022008844ULL, 0x2004101002408004ULL, 0x00128808150D4002ULL,
+	0x4082808401014003ULL, 0x0404024262101004ULL, 0x1040000100809000ULL, 0x4008008030840400ULL,
+	0x0140400091020200ULL, 0x0100102005011201ULL, 0x4840040842080201ULL, 0x00101400B0860200ULL
+};
+
+Chess::Magic::Magic() : pext(hasPext())
+{
+	uint64_t* next = attacks;
+
+	initialize(rooks, true, next);
+	initialize(bishops, false, next);
+}
+
+void Chess::Magic::initialize(Entry* entries, bool straight, uint64_t*& next)
+{
+	const uint64_t fileA = 0x0101010101010101ULL;
+	const uint64_t rank1 = 0xFFULL;
+
+	for(unsigned tile = 0; tile < 64; tile++)
+	{
+		Entry& entry = entries[tile];
+		uint64_t b = 1ULL << tile;
+
+		/*	Pieces on the edge of the board can't block anything. Edges
+		 *	that the piece is on are needed for moves along that edge */
+		uint64_t edges =	((rank1 | rank1 << 56) & ~(rank1 << (tile & ~7))) |
+							((fileA | fileA << 7) & ~(fileA << (tile & 7)));
+
+		entry.mask = (straight ? BitBoard::straightAttacks(b, ~0ULL) : BitBoard::slantAttacks(b, ~0ULL)) & ~edges;
+		entry.magic = straight ? rookMagics[tile] : bishopMagics[tile];
+		entry.shift = 64 - __builtin_popcountll(entry.mask);
+		entry.attacks = next;
+
+		//	Go through each subset of the mask and store what the slider attacks
+		uint64_t subset = 0;
+		do
+		{
+			uint64_t attacks = straight ? BitBoard::straightAttacks(b, ~subset) : BitBoard::slantAttacks(b, ~subset);
+			entry.attacks[index(entry, subset)] = attacks;
+
+			subset = (subset - entry.mask) & entry.mask;
+		} while(subset);
+
+		next += 1ULL << __builtin_popcountll(entry.mask);
+	}
+}
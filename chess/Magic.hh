@@ -0,0 +1,71 @@
+#ifndef CHESS_MAGIC_HEADER
+#define CHESS_MAGIC_HEADER
+
+#include <cstdint>
+
+namespace Chess
+{
+
+/*	Magic contains lookup tables for the attacks of sliding pieces on 8x8
+ *	bitboards. The pieces that could block a slider are turned into a table
+ *	index either with a magic multiplication or with the PEXT instruction if
+ *	the CPU supports BMI2. The tables are built when they're first needed */
+class Magic
+{
+public:
+	static uint64_t rookAttacks(unsigned tile, uint64_t occupied)
+	{
+		const Magic& t = tables();
+		return t.rooks[tile].attacks[t.index(t.rooks[tile], occupied)];
+	}
+
+	static uint64_t bishopAttacks(unsigned tile, uint64_t occupied)
+	{
+		const Magic& t = tables();
+		return t.bishops[tile].attacks[t.index(t.bishops[tile], occupied)];
+	}
+
+	//	Is PEXT used instead of magic multiplication
+	static bool usesPext() { return tables().pext; }
+
+private:
+	struct Entry
+	{
+		uint64_t mask;
+		uint64_t magic;
+		unsigned shift;
+		uint64_t* attacks;
+	};
+
+	Magic();
+	void initialize(Entry* entries, bool straight, uint64_t*& next);
+
+	//	The lookups are inline so the tables are too
+	static const Magic& tables()
+	{
+		static const Magic instance;
+		return instance;
+	}
+
+	static uint64_t parallelExtract(uint64_t bits, uint64_t mask);
+
+	uint64_t index(const Entry& entry, uint64_t occupied) const
+	{
+		if(pext)
+			return parallelExtract(occupied, entry.mask);
+
+		return ((occupied & entry.mask) * entry.magic) >> entry.shift;
+	}
+
+	Entry rooks[64];
+	Entry bishops[64];
+
+	//	Every rook and bishop configuration fits in these
+	uint64_t attacks[102400 + 5248];
+
+	bool pext;
+};
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef CHESS_MOVE_HEADER
+#define CHESS_MOVE_HEADER
+
+#include "../Vector2.hh"
+#include "Piece.hh"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Chess
+{
+
+/*	Move packs the origin tile, the target tile, flags and the promotion piece
+ *	in to 32 bits. Tiles are stored as y * 16 + x so boards are limited to 16x16 */
+class Move
+{
+public:
+	enum Flag : uint32_t
+	{
+		Capture = 1 << 0,
+		DoubleStep = 1 << 1,
+		EnPassant = 1 << 2,
+		Castling = 1 << 3,
+		Promotion = 1 << 4
+	};
+
+	Move() : data(0) {}
+	Move(const Vec2s& from, const Vec2s& to, uint32_t flags = 0, PieceName promotion = PieceName::None)
+		: data(encode(from) | (encode(to) << 8) | (flags << 16) | (static_cast <uint32_t> (promotion) << 24)) {}
+
+	Vec2s from() const { return decode(data); }
+	Vec2s to() const { return decode(data >> 8); }
+	uint32_t flags() const { return (data >> 16) & 0xFF; }
+	PieceName promotion() const { return static_cast <PieceName> ((data >> 24) & 0xF); }
+
+	bool is(Flag flag) const { return flags() & flag; }
+	MoveType type() const { return is(Capture) ? MoveType::Capture : MoveType::Move; }
+
+	//	Promotions to anything else than a queen share the target tile with the queen promotion
+	bool underpromotion() const { return is(Promotion) && promotion() != PieceName::Queen; }
+
+	bool operator==(const Move& rhs) const { return data == rhs.data; }
+	bool operator!=(const Move& rhs) const { return data != rhs.data; }
+
+	uint32_t raw() const { return data; }
+	static Move fromRaw(uint32_t raw) { Move m; m.data = raw; return m; }
+
+private:
+	static uint32_t encode(const Vec2s& tile) { return (tile.y << 4 | tile.x) & 0xFF; }
+	static Vec2s decode(uint32_t tile) { return Vec2s(tile & 0xF, (tile >> 4) & 0xF); }
+
+	uint32_t data;
+};
+
+/*	MoveList is a fixed capacity list of moves that lives on the stack
+ *	so that generating moves never allocates memory. The capacity fits
+ *	the moves of any reasonable position, but a 16x16 board crowded with
+ *	queens can have more. Moves that don't fit are dropped and the list
+ *	remembers that it overflowed */
+class MoveList
+{
+public:
+	static const size_t capacity = 1024;
+
+	//	The moves are left uninitialized so that creating a list doesn't clear 4 KB
+	MoveList() {}
+
+	void add(const Move& move)
+	{
+		if(count < capacity) moves[count++] = move;
+		else overflow = true;
+	}
+
+	void clear() { count = 0; overflow = false; }
+
+	//	Were moves dropped since the list was created or cleared
+	bool overflowed() const { return overflow; }
+
+	//	Only the first "newSize" moves are kept
+	void resize(size_t newSize) { count = newSize; }
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	Move& operator[](size_t index) { return moves[index]; }
+	const Move& operator[](size_t index) const { return moves[index]; }
+
+	Move* begin() { return moves; }
+	Move* end() { return moves + count; }
+	const Move* begin() const { return moves; }
+	const Move* end() const { return moves + count; }
+
+private:
+	union
+	{
+		Move moves[capacity];
+	};
+
+	size_t count = 0;
+	bool overflow = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include "MoveTables.hh"
+
+#include <cstdlib>
+#include <mutex>
+
+const Vec2i Chess::MoveTables::directions[8]
+{
+	Vec2i(-1, 0), Vec2i(0, -1), Vec2i(0, 1), Vec2i(1, 0),
+	Vec2i(-1, -1), Vec2i(1, -1), Vec2i(-1, 1), Vec2i(1, 1)
+};
+
+const Chess::MoveTables* Chess::MoveTables::get(const Vec2s& size, const Player* players, size_t count)
+{
+	static std::mutex lock;
+	static std::vector <std::unique_ptr <const MoveTables>> cache;
+
+	std::lock_guard <std::mutex> guard(lock);
+
+	//	Most programs only ever use a few layouts
+	for(auto& tables : cache)
+	{
+		if(tables->sameLayout(size, players, count))
+			return tables.get();
+	}
+
+	cache.emplace_back(new MoveTables(size, players, count));
+	return cache.back().get();
+}
+
+const int Chess::MoveTables::pieceValues[7] { 0, 100, 330, 320, 500, 900, 0 };
+
+Chess::MoveTables::MoveTables(const Vec2s& size, const Player* players, size_t count)
+	: size(size), layout(players, players + count)
+{
+	auto isInside = [&size](const Vec2i& p)
+	{
+		return p.x >= 0 && p.y >= 0 && p.x < static_cast <int> (size.x) && p.y < static_cast <int> (size.y);
+	};
+
+	auto add = [&isInside](Targets& targets, const Vec2i& p)
+	{
+		if(isInside(p))
+			targets.tiles[targets.count++] = tile(p.as <size_t> ());
+	};
+
+	const Vec2i knightMoves[]
+	{
+		Vec2i(-1, -2), Vec2i(1, -2), Vec2i(2, -1), Vec2i(2, 1),
+		Vec2i(1, 2), Vec2i(-1, 2), Vec2i(-2, -1), Vec2i(-2, 1)
+	};
+
+	for(size_t x = 0; x < size.x; x++)
+	{
+		for(size_t y = 0; y < size.y; y++)
+		{
+			Vec2s position(x, y);
+			Vec2i from = position.as <int> ();
+			unsigned t = tile(position);
+
+			for(auto& move : knightMoves)
+				add(knights[t], from + move);
+
+			//	Pieces other than the king are a bit better near the middle
+			int distance =	abs(static_cast <int> (x * 2) - static_cast <int> (size.x - 1)) +
+							abs(static_cast <int> (y * 2) - static_cast <int> (size.y - 1));
+
+			for(size_t piece = 1; piece < 7; piece++)
+			{
+				pieceSquares[piece][t] = pieceValues[piece];
+				if(piece != static_cast <size_t> (PieceName::King))
+					pieceSquares[piece][t] += static_cast <int> (size.x + size.y) - distance;
+			}
+
+			for(size_t i = 0; i < 8; i++)
+			{
+				add(kings[t], from + directions[i]);
+
+				//	Rays continue until the edge of the board
+				for(Vec2i current = from + directions[i]; isInside(current); current = current + directions[i])
+					rays[t][i].tiles[rays[t][i].length++] = tile(current.as <size_t> ());
+			}
+
+			for(size_t id = 0; id < count && id < maxPlayers; id++)
+			{
+				const Player& player = players[id];
+
+				//	Count rows from the back rank of the player and columns along it
+				Vec2i direction = player.pawnDirection;
+				size_t forward = direction.y > 0 ? y : direction.y < 0 ? size.y - 1 - y : direction.x > 0 ? x : size.x - 1 - x;
+				size_t side = direction.y != 0 ? x : y;
+				relativeTiles[id][t] = tile(Vec2s(side, forward));
+
+				add(pawnPushes[id][t], from + player.pawnDirection);
+				add(pawnAttacks[id][t], from + player.pawnDirection + player.inverseDirection);
+				add(pawnAttacks[id][t], from + player.pawnDirection - player.inverseDirection);
+
+				//	Pawns that are on the same row as where they spawned haven't moved
+				if((position - player.pawnSpawnStart) * player.pawnDirection == Vec2s())
+					pawnFlags[id][t] |= OnSpawn;
+
+				//	En passant could be possible if the pawn is on the 5th rank
+				Vec2s spawnDiff = (position - player.pawnSpawnStart) * player.pawnDirection;
+				if(spawnDiff.x == 3 || spawnDiff.y == 3)
+					pawnFlags[id][t] |= EnPassantRank;
+
+				//	When only the pawn direction is accounted for, where is the pawn?
+				Vec2s pawnProgress = position * player.pawnDirection.abs();
+				Vec2s pawnGoal(0, 0);
+
+				//	If the pawn direction isn't negative, the goal is on the other side of the board
+				if(player.pawnDirection >= Vec2i())
+					pawnGoal = (size - Vec2s(1, 1)) * player.pawnDirection.abs();
+
+				if(pawnProgress == pawnGoal)
+					pawnFlags[id][t] |= Promotes;
+			}
+		}
+	}
+}
+
+bool Chess::MoveTables::sameLayout(const Vec2s& size, const Player* players, size_t count) const
+{
+	if(size != this->size || count != layout.size())
+		return false;
+
+	for(size_t i = 0; i < count; i++)
+	{
+		if(	players[i].pawnDirection != layout[i].pawnDirection ||
+			players[i].inverseDirection != layout[i].inverseDirection ||
+			players[i].pawnSpawnStart != layout[i].pawnSpawnStart)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
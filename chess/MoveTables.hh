@@ -0,0 +1,99 @@
+#ifndef CHESS_MOVE_TABLES_HEADER
+#define CHESS_MOVE_TABLES_HEADER
+
+#include "../Vector2.hh"
+#include "Player.hh"
+#include "Piece.hh"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Chess
+{
+
+/*	MoveTables contains the tiles that each piece can reach from each tile and
+ *	what each piece is worth on each tile. They only depend on the board size
+ *	and where the players are, so games with the same layout share the same
+ *	tables. Tiles are stored as y << 4 | x */
+class MoveTables
+{
+public:
+	static const size_t maxSize = 16;
+	static const size_t maxTiles = maxSize * maxSize;
+	static const size_t maxPlayers = 4;
+
+	//	Material values of each piece indexed by PieceName
+	static const int pieceValues[7];
+
+	//	The first 4 directions are straight and the rest are slant. Direction i ^ 3 is the opposite of i
+	static const Vec2i directions[8];
+
+	enum PawnFlag : uint8_t
+	{
+		OnSpawn = 1,
+		Promotes = 2,
+		EnPassantRank = 4
+	};
+
+	struct Targets
+	{
+		uint8_t count = 0;
+		uint8_t tiles[8];
+
+		const uint8_t* begin() const { return tiles; }
+		const uint8_t* end() const { return tiles + count; }
+	};
+
+	struct Ray
+	{
+		uint8_t length = 0;
+		uint8_t tiles[15];
+	};
+
+	/*	get() returns the tables of the given layout. Tables are built when a
+	 *	layout is first seen and they're never freed */
+	static const MoveTables* get(const Vec2s& size, const Player* players, size_t count);
+
+	static unsigned tile(const Vec2s& position) { return position.y << 4 | position.x; }
+	static Vec2s position(unsigned tile) { return Vec2s(tile & 15, tile >> 4); }
+
+	const Targets& knight(unsigned tile) const { return knights[tile]; }
+	const Targets& king(unsigned tile) const { return kings[tile]; }
+	const Ray& ray(unsigned tile, size_t direction) const { return rays[tile][direction]; }
+
+	//	The push contains nothing if the pawn is at the edge of the board
+	const Targets& pawnPush(size_t playerID, unsigned tile) const { return pawnPushes[playerID][tile]; }
+	const Targets& pawnCaptures(size_t playerID, unsigned tile) const { return pawnAttacks[playerID][tile]; }
+	bool pawnIs(size_t playerID, unsigned tile, PawnFlag flag) const { return pawnFlags[playerID][tile] & flag; }
+
+	/*	The material value of a piece plus a bonus for being near the middle.
+	 *	Positions keep the sum of these for each player as pieces move */
+	int pieceSquare(PieceName piece, unsigned tile) const { return pieceSquares[static_cast <size_t> (piece)][tile]; }
+
+	/*	The tile as seen by the given player when their pawns move up. The
+	 *	back rank of every player is y = 0 so that players can share weights */
+	unsigned relativeTile(size_t playerID, unsigned tile) const { return relativeTiles[playerID][tile]; }
+
+private:
+	MoveTables(const Vec2s& size, const Player* players, size_t count);
+	bool sameLayout(const Vec2s& size, const Player* players, size_t count) const;
+
+	Vec2s size;
+	std::vector <Player> layout;
+
+	Targets knights[maxTiles];
+	Targets kings[maxTiles];
+	Ray rays[maxTiles][8];
+
+	Targets pawnPushes[maxPlayers][maxTiles];
+	Targets pawnAttacks[maxPlayers][maxTiles];
+	uint8_t pawnFlags[maxPlayers][maxTiles] {};
+
+	int16_t pieceSquares[7][maxTiles] {};
+	uint8_t relativeTiles[maxPlayers][maxTiles] {};
+};
+
+}
+
+#endif
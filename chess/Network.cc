@@ -0,0 +1,249 @@
+#include "Network.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHESS_NETWORK_X86
+#include <immintrin.h>
+#endif
+
+//	Files written by save() start with this
+static const char magic[4] { 'C', 'H', 'N', 'N' };
+static const uint32_t version = 1;
+
+static const size_t hiddenSize = Chess::Network::hiddenSize;
+
+static void addScalar(int16_t* values, const int16_t* row)
+{
+	for(size_t i = 0; i < hiddenSize; i++)
+		values[i] += row[i];
+}
+
+static void removeScalar(int16_t* values, const int16_t* row)
+{
+	for(size_t i = 0; i < hiddenSize; i++)
+		values[i] -= row[i];
+}
+
+static int32_t dotScalar(const int16_t* values, const int16_t* weights)
+{
+	int limit = Chess::Network::activationLimit;
+	int32_t sum = 0;
+
+	for(size_t i = 0; i < hiddenSize; i++)
+		sum += std::clamp <int> (values[i], 0, limit) * weights[i];
+
+	return sum;
+}
+
+#ifdef CHESS_NETWORK_X86
+
+/*	The accumulators are aligned but the rows of the input weights only
+ *	have the alignment of the allocator so they're loaded unaligned */
+__attribute__((target("sse2")))
+static void addSSE2(int16_t* values, const int16_t* row)
+{
+	for(size_t i = 0; i < hiddenSize; i += 8)
+	{
+		__m128i* v = reinterpret_cast <__m128i*> (values + i);
+		*v = _mm_add_epi16(*v, _mm_loadu_si128(reinterpret_cast <const __m128i*> (row + i)));
+	}
+}
+
+__attribute__((target("sse2")))
+static void removeSSE2(int16_t* values, const int16_t* row)
+{
+	for(size_t i = 0; i < hiddenSize; i += 8)
+	{
+		__m128i* v = reinterpret_cast <__m128i*> (values + i);
+		*v = _mm_sub_epi16(*v, _mm_loadu_si128(reinterpret_cast <const __m128i*> (row + i)));
+	}
+}
+
+__attribute__((target("sse2")))
+static int32_t dotSSE2(const int16_t* values, const int16_t* weights)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i limit = _mm_set1_epi16(Chess::Network::activationLimit);
+	__m128i sum = zero;
+
+	for(size_t i = 0; i < hiddenSize; i += 8)
+	{
+		__m128i v = _mm_load_si128(reinterpret_cast <const __m128i*> (values + i));
+		__m128i w = _mm_load_si128(reinterpret_cast <const __m128i*> (weights + i));
+
+		v = _mm_min_epi16(_mm_max_epi16(v, zero), limit);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(v, w));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+
+	return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+static void addAVX2(int16_t* values, const int16_t* row)
+{
+	for(size_t i = 0; i < hiddenSize; i += 16)
+	{
+		__m256i* v = reinterpret_cast <__m256i*> (values + i);
+		*v = _mm256_add_epi16(*v, _mm256_loadu_si256(reinterpret_cast <const __m256i*> (row + i)));
+	}
+}
+
+__attribute__((target("avx2")))
+static void removeAVX2(int16_t* values, const int16_t* row)
+{
+	for(size_t i = 0; i < hiddenSize; i += 16)
+	{
+		__m256i* v = reinterpret_cast <__m256i*> (values + i);
+		*v = _mm256_sub_epi16(*v, _mm256_loadu_si256(reinterpret_cast <const __m256i*> (row + i)));
+	}
+}
+
+__attribute__((target("avx2")))
+static int32_t dotAVX2(const int16_t* values, const int16_t* weights)
+{
+	__m256i zero = _mm256_setzero_si256();
+	__m256i limit = _mm256_set1_epi16(Chess::Network::activationLimit);
+	__m256i sum = zero;
+
+	for(size_t i = 0; i < hiddenSize; i += 16)
+	{
+		__m256i v = _mm256_load_si256(reinterpret_cast <const __m256i*> (values + i));
+		__m256i w = _mm256_load_si256(reinterpret_cast <const __m256i*> (weights + i));
+
+		v = _mm256_min_epi16(_mm256_max_epi16(v, zero), limit);
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, w));
+	}
+
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+
+	return _mm_cvtsi128_si32(half);
+}
+
+#endif
+
+Chess::Network::Network() : weights(featureCount * hiddenSize, 0)
+{
+	setKernel(bestKernel());
+}
+
+Chess::Network::Kernel Chess::Network::bestKernel()
+{
+#ifdef CHESS_NETWORK_X86
+	if(__builtin_cpu_supports("avx2")) return Kernel::AVX2;
+	if(__builtin_cpu_supports("sse2")) return Kernel::SSE2;
+#endif
+
+	return Kernel::Scalar;
+}
+
+bool Chess::Network::setKernel(Kernel kernel)
+{
+	//	Kernels that are better than the best one aren't supported
+	if(static_cast <int> (kernel) > static_cast <int> (bestKernel()))
+		return false;
+
+	this->kernel = kernel;
+	addRow = addScalar;
+	removeRow = removeScalar;
+	dot = dotScalar;
+
+#ifdef CHESS_NETWORK_X86
+	switch(kernel)
+	{
+		case Kernel::AVX2: addRow = addAVX2; removeRow = removeAVX2; dot = dotAVX2; break;
+		case Kernel::SSE2: addRow = addSSE2; removeRow = removeSSE2; dot = dotSSE2; break;
+		case Kernel::Scalar: break;
+	}
+#endif
+
+	return true;
+}
+
+bool Chess::Network::load(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if(!file)
+		return false;
+
+	char header[4];
+	uint32_t fileVersion = 0;
+	uint32_t hidden = 0;
+	uint32_t features = 0;
+
+	/*	The values are read in to temporary buffers so that a file that
+	 *	ends too early or doesn't match leaves the network untouched */
+	std::vector <int16_t> newWeights(weights.size());
+	int16_t newBiases[hiddenSize];
+	int16_t newOutput[hiddenSize];
+	int32_t newOutputBias;
+
+	//	The values are stored in the byte order of the machine that saved them
+	bool ok =	fread(header, sizeof(header), 1, file) == 1 && !memcmp(header, magic, sizeof(magic)) &&
+				fread(&fileVersion, sizeof(fileVersion), 1, file) == 1 && fileVersion == version &&
+				fread(&hidden, sizeof(hidden), 1, file) == 1 && hidden == hiddenSize &&
+				fread(&features, sizeof(features), 1, file) == 1 && features == featureCount &&
+				fread(newWeights.data(), sizeof(int16_t), newWeights.size(), file) == newWeights.size() &&
+				fread(newBiases, sizeof(newBiases), 1, file) == 1 &&
+				fread(newOutput, sizeof(newOutput), 1, file) == 1 &&
+				fread(&newOutputBias, sizeof(newOutputBias), 1, file) == 1;
+
+	fclose(file);
+	if(!ok)
+		return false;
+
+	weights.swap(newWeights);
+	std::copy(newBiases, newBiases + hiddenSize, biases);
+	std::copy(newOutput, newOutput + hiddenSize, output);
+	outputBias = newOutputBias;
+
+	return true;
+}
+
+bool Chess::Network::save(const char* path) const
+{
+	FILE* file = fopen(path, "wb");
+	if(!file)
+		return false;
+
+	uint32_t hidden = hiddenSize;
+	uint32_t features = featureCount;
+
+	bool ok =	fwrite(magic, sizeof(magic), 1, file) == 1 &&
+				fwrite(&version, sizeof(version), 1, file) == 1 &&
+				fwrite(&hidden, sizeof(hidden), 1, file) == 1 &&
+				fwrite(&features, sizeof(features), 1, file) == 1 &&
+				fwrite(weights.data(), sizeof(int16_t), weights.size(), file) == weights.size() &&
+				fwrite(biases, sizeof(biases), 1, file) == 1 &&
+				fwrite(output, sizeof(output), 1, file) == 1 &&
+				fwrite(&outputBias, sizeof(outputBias), 1, file) == 1;
+
+	return fclose(file) == 0 && ok;
+}
+
+void Chess::Network::clear(Accumulator& accumulator, size_t perspective) const
+{
+	std::copy(biases, biases + hiddenSize, accumulator.values[perspective]);
+}
+
+void Chess::Network::add(Accumulator& accumulator, size_t perspective, size_t feature) const
+{
+	addRow(accumulator.values[perspective], &weights[feature * hiddenSize]);
+}
+
+void Chess::Network::remove(Accumulator& accumulator, size_t perspective, size_t feature) const
+{
+	removeRow(accumulator.values[perspective], &weights[feature * hiddenSize]);
+}
+
+int Chess::Network::evaluate(const Accumulator& accumulator, size_t perspective) const
+{
+	return (dot(accumulator.values[perspective], output) + outputBias) / outputScale;
+}
@@ -0,0 +1,100 @@
+#ifndef CHESS_NETWORK_HEADER
+#define CHESS_NETWORK_HEADER
+
+#include "MoveTables.hh"
+#include "Piece.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Chess
+{
+
+/*	Network is a small neural network that scores positions. Each input tells
+ *	that a piece is on a tile, and the inputs are given from the perspective of
+ *	a player: tiles are relative to their back rank and owners are relative to
+ *	them. That way the same weights work for every player, any board up to 16x16
+ *	and any player count.
+ *
+ *	The first layer is an accumulator of the weights of the inputs that are on.
+ *	Positions keep one for each player up to date as pieces move, so evaluating
+ *	a position only needs the output layer */
+class Network
+{
+public:
+	static const size_t hiddenSize = 64;
+	static const size_t pieceTypes = 6;
+	static const size_t featureCount = MoveTables::maxPlayers * pieceTypes * MoveTables::maxTiles;
+
+	//	The output is divided by this to get centipawns
+	static const int outputScale = 64;
+
+	//	Hidden values are clamped to 0 - activationLimit before the output layer
+	static const int activationLimit = 127;
+
+	struct Accumulator
+	{
+		alignas(32) int16_t values[MoveTables::maxPlayers][hiddenSize];
+	};
+
+	//	Which instructions the accumulator and the output layer are computed with
+	enum class Kernel
+	{
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	//	Every weight starts from zero. The fastest kernel that the CPU supports is used
+	Network();
+
+	/*	load() reads weights written by save(). Returns false without changing
+	 *	the network if the file can't be read or it's for a network of a different
+	 *	size. Games that already use the network have to be given it again with
+	 *	setNetwork() after a successful load so that their accumulators match */
+	bool load(const char* path);
+	bool save(const char* path) const;
+
+	//	The weights can also be set directly, for example by a trainer
+	int16_t* inputWeights(size_t feature) { return &weights[feature * hiddenSize]; }
+	int16_t* hiddenBiases() { return biases; }
+	int16_t* outputWeights() { return output; }
+	void setOutputBias(int32_t bias) { outputBias = bias; }
+
+	//	Returns false if the CPU doesn't support the given kernel
+	bool setKernel(Kernel kernel);
+	Kernel getKernel() const { return kernel; }
+	static Kernel bestKernel();
+
+	/*	feature() returns the input that is on when the given piece is on the given
+	 *	tile. The tile and the owner are relative to the given perspective */
+	static size_t feature(PieceName piece, size_t relativeOwner, unsigned relativeTile)
+	{
+		return (relativeOwner * pieceTypes + static_cast <size_t> (piece) - 1) * MoveTables::maxTiles + relativeTile;
+	}
+
+	//	Sets the accumulator of a perspective to the biases
+	void clear(Accumulator& accumulator, size_t perspective) const;
+
+	void add(Accumulator& accumulator, size_t perspective, size_t feature) const;
+	void remove(Accumulator& accumulator, size_t perspective, size_t feature) const;
+
+	//	evaluate() returns the score of the given perspective in centipawns
+	int evaluate(const Accumulator& accumulator, size_t perspective) const;
+
+private:
+	std::vector <int16_t> weights;
+	alignas(32) int16_t biases[hiddenSize] {};
+	alignas(32) int16_t output[hiddenSize] {};
+	int32_t outputBias = 0;
+
+	Kernel kernel;
+	void (*addRow)(int16_t* values, const int16_t* row);
+	void (*removeRow)(int16_t* values, const int16_t* row);
+	int32_t (*dot)(const int16_t* values, const int16_t* weights);
+};
+
+}
+
+#endif
@@ -0,0 +1,442 @@
+#include "PGN.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+static bool isSpace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static bool isFile(char c)
+{
+	//	Boards can be 16 tiles wide so files go from a to p
+	return c >= 'a' && c <= 'p';
+}
+
+//	Characters that end a move
+static bool isDelimiter(char c)
+{
+	switch(c)
+	{
+		case '{': case '}': case '(': case ')': case '[':
+		case ']': case ';': case '$': case '.':
+			return true;
+	}
+
+	return isSpace(c);
+}
+
+static bool isResult(std::string_view token)
+{
+	return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+//	SAN uses uppercase letters for pieces
+static Chess::PieceName pieceFromLetter(char letter)
+{
+	switch(letter)
+	{
+		case 'P': return Chess::PieceName::Pawn;
+		case 'N': return Chess::PieceName::Knight;
+		case 'B': return Chess::PieceName::Bishop;
+		case 'R': return Chess::PieceName::Rook;
+		case 'Q': return Chess::PieceName::Queen;
+		case 'K': return Chess::PieceName::King;
+	}
+
+	return Chess::PieceName::None;
+}
+
+//	Is the given castling target closer to the queenside rook than to the kingside rook
+static bool queenSide(const Chess::Player& player, const Vec2s& target)
+{
+	auto distance = [&target](const Vec2s& tile)
+	{
+		return	abs(static_cast <int> (tile.x) - static_cast <int> (target.x)) +
+				abs(static_cast <int> (tile.y) - static_cast <int> (target.y));
+	};
+
+	return distance(player.rookPosition[1]) < distance(player.rookPosition[0]);
+}
+
+/*	Tags start lines, and the first tag of a game follows the moves
+ *	of the previous game instead of another tag */
+static bool gameStarts(std::string_view text, size_t at)
+{
+	if(text[at] != '[' || (at > 0 && text[at - 1] != '\n'))
+		return false;
+
+	//	Comments like { [%clk 0:03:00] } can also start a line
+	if(at + 1 >= text.size() || !((text[at + 1] | 0x20) >= 'a' && (text[at + 1] | 0x20) <= 'z'))
+		return false;
+
+	while(at > 0 && isSpace(text[at - 1]))
+		at--;
+
+	return at == 0 || text[at - 1] != ']';
+}
+
+bool Chess::PGNReader::next(Game& game, PGNGame& info)
+{
+	static const char* standard = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+	info = PGNGame();
+	skipSpace();
+
+	if(atEnd())
+		return false;
+
+	//	The value of the FEN tag isn't terminated so it's copied
+	char fen[Position::maxFENLength];
+	const char* start = standard;
+	std::string_view fenTag;
+
+	while(!atEnd() && text[offset] == '[')
+	{
+		std::string_view name;
+		std::string_view value;
+		size_t tagStart = offset;
+
+		if(!readTag(name, value))
+			info.error = text.substr(tagStart, offset - tagStart);
+
+		else if(name == "FEN")
+		{
+			fenTag = value;
+			if(value.size() >= sizeof(fen))
+				info.error = value;
+
+			else
+			{
+				memcpy(fen, value.data(), value.size());
+				fen[value.size()] = 0;
+				start = fen;
+			}
+		}
+
+		skipSpace();
+	}
+
+	if(!game.fromFEN(start) && !info.failed())
+		info.error = fenTag;
+
+	for(std::string_view token = nextToken(); !token.empty(); token = nextToken())
+	{
+		if(isResult(token))
+		{
+			info.result = token;
+			break;
+		}
+
+		//	The moves after a failure are skipped because they can't be resolved
+		if(info.failed())
+			continue;
+
+		Move move;
+		if(!resolve(game, token, move))
+		{
+			info.error = token;
+			continue;
+		}
+
+		Game::Undo undo;
+		game.makeMove(move, undo);
+		info.moves++;
+	}
+
+	return true;
+}
+
+std::vector <std::string_view> Chess::PGNReader::split(std::string_view text, size_t parts)
+{
+	std::vector <std::string_view> result;
+	size_t begin = 0;
+
+	for(size_t i = 1; i <= parts && begin < text.size(); i++)
+	{
+		size_t end = text.size();
+
+		//	The boundary is moved forward until the next game starts
+		if(i < parts)
+		{
+			end = std::max(begin, text.size() / parts * i);
+
+			while(end < text.size() && !gameStarts(text, end))
+			{
+				end = text.find('\n', end);
+				end = end == std::string_view::npos ? text.size() : end + 1;
+			}
+		}
+
+		if(end > begin)
+			result.push_back(text.substr(begin, end - begin));
+
+		begin = end;
+	}
+
+	return result;
+}
+
+bool Chess::PGNReader::resolve(Game& game, std::string_view san, Move& move)
+{
+	//	Checks and annotations like "+", "#" and "!?" don't change the move
+	while(!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?'))
+		san.remove_suffix(1);
+
+	size_t turn = game.getCurrentTurn();
+	const Player& player = game.getPlayer(turn);
+	MoveList list;
+
+	//	Castling is written with the letter O but some programs use zeros
+	if(san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+	{
+		game.legalMoves(player.kingPosition, list);
+
+		for(auto& m : list)
+		{
+			if(m.is(Move::Castling) && queenSide(player, m.to()) == (san.size() == 5))
+			{
+				move = m;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//	Pawn moves don't name the piece
+	PieceName piece = PieceName::Pawn;
+	if(!san.empty() && san[0] >= 'A' && san[0] <= 'Z')
+	{
+		piece = pieceFromLetter(san[0]);
+		san.remove_prefix(1);
+	}
+
+	//	Promotions end with the new piece, usually after "="
+	PieceName promotion = PieceName::None;
+	if(piece == PieceName::Pawn && !san.empty() && san.back() >= 'A' && san.back() <= 'Z')
+	{
+		promotion = pieceFromLetter(san.back());
+		san.remove_suffix(1);
+
+		if(!san.empty() && san.back() == '=')
+			san.remove_suffix(1);
+
+		if(promotion == PieceName::Pawn || promotion == PieceName::King)
+			return false;
+	}
+
+	if(piece == PieceName::None)
+		return false;
+
+	//	The target tile comes last. Large boards can have ranks with 2 digits
+	size_t digits = 0;
+	while(digits < 2 && digits < san.size() && isDigit(san[san.size() - digits - 1]))
+		digits++;
+
+	if(digits == 0 || san.size() == digits || !isFile(san[san.size() - digits - 1]))
+		return false;
+
+	size_t rank = 0;
+	for(size_t i = san.size() - digits; i < san.size(); i++)
+		rank = rank * 10 + san[i] - '0';
+
+	Vec2s to(san[san.size() - digits - 1] - 'a', rank - 1);
+	san.remove_suffix(digits + 1);
+
+	Vec2s size = game.getBoardSize();
+	if(rank == 0 || to.x >= size.x || to.y >= size.y)
+		return false;
+
+	bool capture = !san.empty() && (san.back() == 'x' || san.back() == ':');
+	if(capture)
+		san.remove_suffix(1);
+
+	//	The origin is only given as much as is needed to tell the pieces apart
+	size_t fromX = size.x;
+	size_t fromY = size.y;
+
+	if(!san.empty() && isFile(san[0]))
+	{
+		fromX = san[0] - 'a';
+		san.remove_prefix(1);
+	}
+
+	if(!san.empty())
+	{
+		fromY = 0;
+		for(char c : san)
+		{
+			if(!isDigit(c))
+				return false;
+
+			fromY = fromY * 10 + c - '0';
+		}
+
+		if(fromY-- == 0)
+			return false;
+	}
+
+	//	Pawns that don't capture stay on the same file
+	if(piece == PieceName::Pawn && !capture)
+	{
+		if(player.pawnDirection.x == 0) fromX = to.x;
+		else fromY = to.y;
+	}
+
+	/*	Only the moves that reach the target are checked for legality. Pseudo legal
+	 *	moves don't include en passant so captures to empty tiles are fully checked */
+	bool enPassant = piece == PieceName::Pawn && capture && game.at(to.x, to.y).piece == PieceName::None;
+
+	for(size_t x = fromX < size.x ? fromX : 0; x < (fromX < size.x ? fromX + 1 : size.x); x++)
+	{
+		for(size_t y = fromY < size.y ? fromY : 0; y < (fromY < size.y ? fromY + 1 : size.y); y++)
+		{
+			Tile t = game.at(x, y);
+			if(t.piece == piece && t.playerID == turn)
+				game.legalMoves(Vec2s(x, y), list, enPassant);
+		}
+	}
+
+	size_t found = 0;
+	for(auto& m : list)
+	{
+		if(m.to() != to || m.promotion() != promotion || m.is(Move::Castling))
+			continue;
+
+		if(!enPassant)
+		{
+			Game::Undo undo;
+			game.makeMove(m, undo);
+
+			bool check = game.inCheck(turn);
+			game.unmakeMove(undo);
+
+			if(check)
+				continue;
+		}
+
+		move = m;
+		found++;
+	}
+
+	return found == 1;
+}
+
+std::string_view Chess::PGNReader::nextToken()
+{
+	while(true)
+	{
+		skipSpace();
+		if(atEnd())
+			return std::string_view();
+
+		switch(text[offset])
+		{
+			//	The tags of the next game start
+			case '[':
+				return std::string_view();
+
+			//	Comments and variations aren't part of the game
+			case '{':
+				offset = std::min(text.find('}', offset), text.size());
+				offset++;
+				continue;
+
+			case ';':
+				offset = std::min(text.find('\n', offset), text.size());
+				continue;
+
+			case '(':
+			{
+				size_t depth = 0;
+				for(; !atEnd(); offset++)
+				{
+					char c = text[offset];
+
+					if(c == '(') depth++;
+					else if(c == ')' && --depth == 0) break;
+					else if(c == '{') offset = std::min(text.find('}', offset), text.size() - 1);
+					else if(c == ';') offset = std::min(text.find('\n', offset), text.size() - 1);
+				}
+
+				offset++;
+				continue;
+			}
+
+			//	Annotation glyphs are numbers after "$"
+			case '$':
+				for(offset++; !atEnd() && isDigit(text[offset]); offset++);
+				continue;
+
+			//	Dots after move numbers and stray characters
+			case '.': case ')': case ']': case '}':
+				offset++;
+				continue;
+		}
+
+		size_t start = offset;
+		while(!atEnd() && !isDelimiter(text[offset]))
+			offset++;
+
+		//	Move numbers end with a dot so only digits are left of them
+		std::string_view token = text.substr(start, offset - start);
+		if(std::all_of(token.begin(), token.end(), isDigit))
+			continue;
+
+		return token;
+	}
+}
+
+bool Chess::PGNReader::readTag(std::string_view& name, std::string_view& value)
+{
+	//	Tags look like [Name "Value"] and take a whole line
+	size_t lineEnd = std::min(text.find('\n', offset), text.size());
+	size_t nameStart = offset + 1;
+	size_t nameEnd = nameStart;
+
+	while(nameEnd < lineEnd && !isSpace(text[nameEnd]) && text[nameEnd] != '"')
+		nameEnd++;
+
+	size_t valueStart = text.find('"', nameEnd);
+	size_t valueEnd = valueStart;
+
+	//	Quotes inside the value are escaped with backslashes
+	if(valueStart < lineEnd)
+	{
+		for(valueEnd = valueStart + 1; valueEnd < lineEnd && text[valueEnd] != '"'; valueEnd++)
+			valueEnd += text[valueEnd] == '\\';
+	}
+
+	offset = lineEnd;
+
+	if(valueEnd >= lineEnd || nameEnd == nameStart)
+		return false;
+
+	name = text.substr(nameStart, nameEnd - nameStart);
+	value = text.substr(valueStart + 1, valueEnd - valueStart - 1);
+
+	return true;
+}
+
+void Chess::PGNReader::skipSpace()
+{
+	while(!atEnd())
+	{
+		if(isSpace(text[offset]))
+			offset++;
+
+		//	Lines starting with "%" are meant for other programs
+		else if(text[offset] == '%' && (offset == 0 || text[offset - 1] == '\n'))
+			offset = std::min(text.find('\n', offset), text.size());
+
+		else break;
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef CHESS_PGN_HEADER
+#define CHESS_PGN_HEADER
+
+#include "Game.hh"
+#include "Move.hh"
+
+#include <string_view>
+#include <cstddef>
+#include <vector>
+
+namespace Chess
+{
+
+//	What PGNReader found out about a game while replaying it
+struct PGNGame
+{
+	//	How many moves were replayed
+	size_t moves = 0;
+
+	//	"1-0", "0-1", "1/2-1/2" or "*". Empty if the game ended without a result
+	std::string_view result;
+
+	/*	If the FEN tag is invalid or a move can't be resolved, the rest of
+	 *	the game is skipped and error points to the text that failed */
+	std::string_view error;
+
+	bool failed() const { return !error.empty(); }
+};
+
+/*	PGNReader replays games from PGN text one at a time. The text isn't copied
+ *	so it has to outlive the reader, which makes memory mapped files a good fit.
+ *	Moves are read in place and resolved against the legal moves of the game, so
+ *	a game is validated while it's replayed and nothing is allocated per move */
+class PGNReader
+{
+public:
+	PGNReader(std::string_view text) : text(text) {}
+
+	/*	next() sets up the given game from the tags of the next game and replays
+	 *	its moves with Game::makeMove(). Games without a FEN tag start from the
+	 *	standard position. Returns false when there are no games left */
+	bool next(Game& game, PGNGame& info);
+
+	/*	split() divides the text in to at most "parts" pieces of about the same
+	 *	size. Every piece starts at a game so each one can have its own reader */
+	static std::vector <std::string_view> split(std::string_view text, size_t parts);
+
+	/*	resolve() finds the legal move of the current player that the given move in
+	 *	Standard Algebraic Notation describes. Returns false if there isn't exactly one */
+	static bool resolve(Game& game, std::string_view san, Move& move);
+
+private:
+	//	nextToken() returns an empty token at the end of the game
+	std::string_view nextToken();
+	bool readTag(std::string_view& name, std::string_view& value);
+
+	void skipSpace();
+	bool atEnd() const { return offset >= text.size(); }
+
+	std::string_view text;
+	size_t offset = 0;
+};
+
+}
+
+#endif
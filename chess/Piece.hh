@@ -0,0 +1,55 @@
+#ifndef CHESS_PIECE_HEADER
+#define CHESS_PIECE_HEADER
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Chess
+{
+
+enum class PieceName
+{
+	None,
+	Pawn,
+	Bishop,
+	Knight,
+	Rook,
+	Queen,
+	King
+};
+
+enum class MoveType
+{
+	Move,
+	Capture
+};
+
+struct Tile
+{
+	Tile(PieceName piece, size_t id) : piece(piece), playerID(id) {}
+
+	PieceName piece;
+	size_t playerID;
+};
+
+/*	PackedTile stores a tile in a single byte. The lowest 3 bits
+ *	contain the piece and the rest contain the ID of the owner */
+class PackedTile
+{
+public:
+	PackedTile() : data(0) {}
+	PackedTile(const Tile& tile)
+		: data(static_cast <uint8_t> (static_cast <unsigned> (tile.piece) | tile.playerID << 3)) {}
+
+	PieceName piece() const { return static_cast <PieceName> (data & 7); }
+	size_t playerID() const { return data >> 3; }
+
+	operator Tile() const { return Tile(piece(), playerID()); }
+
+private:
+	uint8_t data;
+};
+
+}
+
+#endif
@@ -9,11 +9,11 @@ namespace Chess
 struct Player
 {
 	bool kingMoved = false;
-	bool kingCanCastle[2] { false, false };
 	bool kingThreatened = false;
 	bool rookMoved[2] { false, false };
 
-	size_t possibleMoves;
+	//	Bots make their moves automatically when it's their turn
+	bool isBot = false;
 
 	Vec2s kingPosition;
 	Vec2i inverseDirection;
@@ -22,8 +22,14 @@ struct Player
 	Vec2s pawnSpawnStart;
 	Vec2s pawnSpawnEnd;
 
-	//	FIXME technically you could have multiple possible en passantes
-	Vec2s enPassanteCapture;
+	//	Where the kingside and queenside rooks are before they move
+	Vec2s rookPosition[2];
+
+	/*	Set when this player's last move was a pawn moving 2 steps. It's cleared
+	 *	when it's this player's turn again because the pawn can't be captured
+	 *	en passant anymore. doubleStepTarget is the tile that the pawn skipped */
+	bool doubleStepped = false;
+	Vec2s doubleStepTarget;
 };
 
 }
@@ -0,0 +1,1649 @@
+#include "Position.hh"
+
+#include <type_traits>
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+
+//	Snapshots of a game are taken by copying the position
+static_assert(std::is_trivially_copyable <Chess::Position>::value, "Position has to be trivially copyable");
+
+template <typename F>
+auto Chess::Position::dispatch(F&& function) const
+{
+	switch(layout)
+	{
+		case Layout::Standard: return function(StandardShape());
+		case Layout::Wide: return function(WideShape());
+		case Layout::FourPlayer: return function(FourPlayerShape());
+		case Layout::Dynamic: break;
+	}
+
+	return function(DynamicShape());
+}
+
+Chess::Position::Position(size_t boardWidth, size_t boardHeight)
+{
+	//	Tiles are stored as y << 4 | x so larger boards would overflow the tile arrays
+	if(boardWidth > MoveTables::maxSize || boardHeight > MoveTables::maxSize)
+		throw std::invalid_argument("The board can be at most 16x16");
+
+	board.size.x = boardWidth;
+	board.size.y = boardHeight;
+	board.hash = Zobrist::turn(currentPlayer);
+	tables = MoveTables::get(board.size, players, 0);
+}
+
+bool Chess::Position::fromFEN(const char* fen)
+{
+	if(*fen == '@')
+		return fromExtendedFEN(fen + 1);
+
+	//	Every standard FEN starts from the same empty board so it's only set up once
+	static const Position empty = []()
+	{
+		Position position(8, 8);
+
+		/*	White is at the bottom of the board and moves up. The kingside rooks
+		 *	start on the right side and the queenside rooks on the left side */
+		for(size_t i = 0; i < 2; i++)
+		{
+			Player& player = position.players[i];
+
+			size_t backRank = i == 0 ? 0 : 7;
+			player.pawnDirection = Vec2i(0, i == 0 ? +1 : -1);
+			player.inverseDirection = Vec2i(1, 0);
+
+			player.pawnSpawnStart = Vec2s(0, backRank + player.pawnDirection.y);
+			player.pawnSpawnEnd = Vec2s(7, backRank + player.pawnDirection.y);
+
+			player.rookPosition[0] = Vec2s(7, backRank);
+			player.rookPosition[1] = Vec2s(0, backRank);
+
+			//	Castling is only allowed if the castling field says so
+			player.kingMoved = true;
+			player.rookMoved[0] = true;
+			player.rookMoved[1] = true;
+		}
+
+		position.board.playerCount = 2;
+		position.tables = MoveTables::get(position.board.size, position.players, position.board.playerCount);
+		position.selectBackend();
+
+		return position;
+	}();
+
+	*this = empty;
+
+	if(!parsePlacement(fen, false) || *fen++ != ' ')
+		return false;
+
+	//	Whose turn is it
+	if(*fen == 'b') nextTurn(0);
+	else if(*fen != 'w') return false;
+
+	if(*++fen != ' ')
+		return false;
+
+	//	Castling rights
+	for(fen++; *fen && *fen != ' '; fen++)
+	{
+		if(*fen == '-') continue;
+
+		size_t id = *fen >= 'a';
+		bool queenSide = (*fen | 0x20) == 'q';
+
+		if((*fen | 0x20) != 'k' && !queenSide)
+			return false;
+
+		players[id].kingMoved = false;
+		players[id].rookMoved[queenSide] = false;
+	}
+
+	board.hash ^= Zobrist::castling(castlingRights());
+
+	//	En passant target
+	if(*fen == ' ' && fen[1] >= 'a' && fen[1] <= 'h' && (fen[2] == '3' || fen[2] == '6'))
+	{
+		Vec2s target(fen[1] - 'a', fen[2] - '1');
+		Player& player = players[!currentPlayer];
+
+		//	Pretend that the previous player moved the pawn 2 steps
+		player.doubleStepped = true;
+		player.doubleStepTarget = target;
+		board.hash ^= Zobrist::enPassant(target);
+	}
+
+	flagThreatenedKings();
+	return true;
+}
+
+static size_t parseNumber(const char*& str)
+{
+	//	Nothing in the notation needs more than 2 digits
+	size_t result = 0;
+	for(size_t i = 0; i < 2 && *str >= '0' && *str <= '9'; i++)
+		result = result * 10 + *str++ - '0';
+
+	return result;
+}
+
+static bool parseTile(const char*& str, Vec2s& tile)
+{
+	//	Boards can be 16 tiles wide so files go from a to p
+	if(*str < 'a' || *str > 'p')
+		return false;
+
+	tile.x = *str++ - 'a';
+	size_t rank = parseNumber(str);
+
+	tile.y = rank - 1;
+	return rank > 0;
+}
+
+static char* writeNumber(char* out, size_t number)
+{
+	if(number >= 10)
+		*out++ = '0' + number / 10;
+
+	*out++ = '0' + number % 10;
+	return out;
+}
+
+static char* writeTile(char* out, const Vec2s& tile)
+{
+	*out++ = 'a' + tile.x;
+	return writeNumber(out, tile.y + 1);
+}
+
+static Chess::PieceName pieceFromLetter(char letter)
+{
+	switch(letter | 0x20)
+	{
+		case 'p': return Chess::PieceName::Pawn;
+		case 'n': return Chess::PieceName::Knight;
+		case 'b': return Chess::PieceName::Bishop;
+		case 'r': return Chess::PieceName::Rook;
+		case 'q': return Chess::PieceName::Queen;
+		case 'k': return Chess::PieceName::King;
+	}
+
+	return Chess::PieceName::None;
+}
+
+//	Lowercase letters of each piece indexed by PieceName
+static const char pieceLetters[] = " pbnrqk";
+
+bool Chess::Position::fromExtendedFEN(const char* fen)
+{
+	size_t width = parseNumber(fen);
+	if(*fen++ != 'x')
+		return false;
+
+	size_t height = parseNumber(fen);
+	if(width == 0 || height == 0 || width > MoveTables::maxSize || height > MoveTables::maxSize || *fen++ != ' ')
+		return false;
+
+	*this = Position(width, height);
+
+	//	Each player is given as a pawn direction and the starting tiles of the rooks
+	for(bool more = true; more; more = *fen == ',' && fen++)
+	{
+		if(board.playerCount == MoveTables::maxPlayers)
+			return false;
+
+		Player& player = players[board.playerCount++];
+		int sign = *fen == '+' ? +1 : *fen == '-' ? -1 : 0;
+		fen++;
+
+		if(sign == 0 || (*fen != 'x' && *fen != 'y'))
+			return false;
+
+		player.pawnDirection = *fen++ == 'x' ? Vec2i(sign, 0) : Vec2i(0, sign);
+		player.inverseDirection = Vec2i(abs(player.pawnDirection.y), abs(player.pawnDirection.x));
+
+		if(	!parseTile(fen, player.rookPosition[0]) || !parseTile(fen, player.rookPosition[1]) ||
+			!board.isInside(player.rookPosition[0]) || !board.isInside(player.rookPosition[1]))
+		{
+			return false;
+		}
+
+		//	The pawns start in front of the rooks
+		player.pawnSpawnStart = player.rookPosition[0] + player.pawnDirection;
+		player.pawnSpawnEnd = player.rookPosition[1] + player.pawnDirection;
+
+		//	Castling is only allowed if the castling field says so
+		player.kingMoved = true;
+		player.rookMoved[0] = true;
+		player.rookMoved[1] = true;
+	}
+
+	if(*fen++ != ' ')
+		return false;
+
+	tables = MoveTables::get(board.size, players, board.playerCount);
+	selectBackend();
+
+	if(!parsePlacement(fen, true) || *fen++ != ' ')
+		return false;
+
+	//	Whose turn is it
+	size_t turn = *fen - '0';
+	if(turn >= board.playerCount || *++fen != ' ')
+		return false;
+
+	fen++;
+
+	if(turn > 0)
+		nextTurn(turn - 1);
+
+	//	Castling rights of each player are separated by commas
+	for(size_t id = 0; *fen && *fen != ' '; fen++)
+	{
+		if(*fen == ',') id++;
+		else if(id >= board.playerCount) return false;
+		else if(*fen == 'k' || *fen == 'q')
+		{
+			players[id].kingMoved = false;
+			players[id].rookMoved[*fen == 'q'] = false;
+		}
+
+		else if(*fen != '-') return false;
+	}
+
+	board.hash ^= Zobrist::castling(castlingRights());
+
+	//	En passant targets
+	if(*fen == ' ' && *++fen != '-')
+	{
+		for(bool more = true; more; more = *fen == ',' && fen++)
+		{
+			size_t id = *fen - '0';
+			Vec2s target;
+
+			if(id >= board.playerCount || !parseTile(++fen, target) || !board.isInside(target))
+				return false;
+
+			players[id].doubleStepped = true;
+			players[id].doubleStepTarget = target;
+			board.hash ^= Zobrist::enPassant(target);
+		}
+	}
+
+	flagThreatenedKings();
+	return true;
+}
+
+bool Chess::Position::parsePlacement(const char*& fen, bool extended)
+{
+	//	Piece placement starts from the top left corner
+	size_t x = 0;
+	size_t y = board.size.y - 1;
+
+	while(*fen && *fen != ' ')
+	{
+		if(*fen == '/')
+		{
+			if(x != board.size.x || y == 0) return false;
+			x = 0;
+			y--;
+			fen++;
+		}
+
+		else if(*fen >= '1' && *fen <= '9')
+			x += parseNumber(fen);
+
+		else
+		{
+			PieceName piece = pieceFromLetter(*fen);
+			if(piece == PieceName::None || x >= board.size.x)
+				return false;
+
+			/*	In standard FEN uppercase letters are white pieces. The
+			 *	extended notation gives the owner after the letter */
+			size_t id = *fen++ >= 'a';
+			if(extended)
+			{
+				id = *fen - '0';
+				if(id >= board.playerCount)
+					return false;
+
+				fen++;
+			}
+
+			setTile(Vec2s(x, y), Tile(piece, id));
+
+			if(piece == PieceName::King)
+				players[id].kingPosition = Vec2s(x, y);
+
+			x++;
+		}
+
+		if(x > board.size.x) return false;
+	}
+
+	return x == board.size.x && y == 0;
+}
+
+bool Chess::Position::standardLayout() const
+{
+	if(board.size != Vec2s(8, 8) || board.playerCount != 2)
+		return false;
+
+	//	White has to start at the bottom with the rooks in the corners
+	for(size_t i = 0; i < 2; i++)
+	{
+		const Player& player = players[i];
+		size_t backRank = i == 0 ? 0 : 7;
+
+		if(	player.pawnDirection != Vec2i(0, i == 0 ? +1 : -1) ||
+			player.rookPosition[0].y != backRank || player.rookPosition[1].y != backRank ||
+			player.rookPosition[0].x + player.rookPosition[1].x != 7 ||
+			(player.rookPosition[0].x != 0 && player.rookPosition[0].x != 7))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t Chess::Position::toFEN(char* buffer, size_t size) const
+{
+	char text[maxFENLength];
+	char* out = text;
+	bool standard = standardLayout();
+
+	if(!standard)
+	{
+		*out++ = '@';
+		out = writeNumber(out, board.size.x);
+		*out++ = 'x';
+		out = writeNumber(out, board.size.y);
+
+		for(size_t i = 0; i < board.playerCount; i++)
+		{
+			const Player& player = players[i];
+			Vec2i dir = player.pawnDirection;
+
+			*out++ = i == 0 ? ' ' : ',';
+			*out++ = dir.x + dir.y > 0 ? '+' : '-';
+			*out++ = dir.x != 0 ? 'x' : 'y';
+
+			out = writeTile(out, player.rookPosition[0]);
+			out = writeTile(out, player.rookPosition[1]);
+		}
+
+		*out++ = ' ';
+	}
+
+	//	Piece placement starts from the top left corner
+	for(size_t y = board.size.y - 1; y < board.size.y; y--)
+	{
+		size_t empty = 0;
+
+		for(size_t x = 0; x < board.size.x; x++)
+		{
+			Tile t = board.at(Vec2s(x, y));
+
+			if(t.piece == PieceName::None)
+			{
+				empty++;
+				continue;
+			}
+
+			if(empty > 0)
+				out = writeNumber(out, empty);
+
+			empty = 0;
+			char letter = pieceLetters[static_cast <size_t> (t.piece)];
+
+			if(standard) *out++ = t.playerID == 0 ? letter - 0x20 : letter;
+			else
+			{
+				*out++ = letter - 0x20;
+				*out++ = '0' + t.playerID;
+			}
+		}
+
+		if(empty > 0)
+			out = writeNumber(out, empty);
+
+		if(y > 0)
+			*out++ = '/';
+	}
+
+	*out++ = ' ';
+	if(standard) *out++ = currentPlayer == 0 ? 'w' : 'b';
+	else *out++ = '0' + currentPlayer;
+
+	//	Castling rights
+	*out++ = ' ';
+	char* rights = out;
+
+	for(size_t i = 0; i < board.playerCount; i++)
+	{
+		const Player& player = players[i];
+
+		if(!standard && i > 0)
+			*out++ = ',';
+
+		char* first = out;
+		if(!player.kingMoved)
+		{
+			//	In standard FEN the kingside is the one with the rook on the h-file
+			size_t kingSide = standard && player.rookPosition[0].x != 7;
+			const char* sides = standard ? (i == 0 ? "KQ" : "kq") : "kq";
+
+			if(!player.rookMoved[kingSide]) *out++ = sides[0];
+			if(!player.rookMoved[!kingSide]) *out++ = sides[1];
+		}
+
+		if(!standard && out == first)
+			*out++ = '-';
+	}
+
+	if(out == rights)
+		*out++ = '-';
+
+	//	En passant targets
+	*out++ = ' ';
+	char* targets = out;
+
+	for(size_t i = 0; i < board.playerCount; i++)
+	{
+		if(!players[i].doubleStepped)
+			continue;
+
+		if(standard)
+		{
+			out = writeTile(out, players[i].doubleStepTarget);
+			break;
+		}
+
+		if(out != targets)
+			*out++ = ',';
+
+		*out++ = '0' + i;
+		out = writeTile(out, players[i].doubleStepTarget);
+	}
+
+	if(out == targets)
+		*out++ = '-';
+
+	//	Move counters aren't tracked
+	if(standard)
+	{
+		const char counters[] = " 0 1";
+		out = std::copy(counters, counters + 4, out);
+	}
+
+	size_t length = out - text;
+	if(length >= size)
+		return 0;
+
+	std::copy(text, out, buffer);
+	buffer[length] = 0;
+
+	return length;
+}
+
+Chess::Player* Chess::Position::addPlayer(const Vec2s& kingPosition, const Vec2s& middle)
+{
+	if(board.playerCount == MoveTables::maxPlayers)
+		return nullptr;
+
+	size_t id = board.playerCount;
+	Player player;
+
+	//	Calculate a direction vector from the king to the middle
+	Vec2i sub = middle.as <int> () - kingPosition.as <int> ();
+	float angle = atan2(sub.y, sub.x);
+	player.pawnDirection = Vec2i(round(cos(angle)), round(sin(angle)));
+
+	//	Invert the direction vector
+	player.inverseDirection = Vec2i(player.pawnDirection.y, player.pawnDirection.x);
+
+	/*	Because we use pawnDirection and inverseDirection to place the pieces, the
+	 *	pieces will be mirrored relative to other player's pieces. If x or y
+	 *	is negative, making them positive will fix the mirroring issue */
+	if(player.inverseDirection.x < 0) player.inverseDirection.x = -player.inverseDirection.x;
+	else if(player.inverseDirection.y < 0) player.inverseDirection.y = -player.inverseDirection.y;
+
+	/*	Define a line where the pawns spawn. This is used to determine if
+	 *	a pawn can move 2 spaces or if en passante can happen */
+	player.pawnSpawnStart = kingPosition + player.pawnDirection + (player.inverseDirection * -3);
+	player.pawnSpawnEnd = player.pawnSpawnStart + (player.inverseDirection * 7);
+
+	player.rookPosition[0] = kingPosition + (player.inverseDirection * -3);
+	player.rookPosition[1] = kingPosition + (player.inverseDirection * 4);
+	player.kingPosition = kingPosition;
+
+	/*	The pieces take 8 tiles from the queenside rook to the kingside rook and the
+	 *	pawns are in front of them. Nothing is changed if any of them is off the board.
+	 *	Tiles off the left or the top edge wrap around to very large coordinates */
+	for(int i = -3; i <= 4; i++)
+	{
+		if(	!board.isInside(kingPosition + (player.inverseDirection * i)) ||
+			!board.isInside(player.pawnSpawnStart + (player.inverseDirection * (i + 3))))
+		{
+			return nullptr;
+		}
+	}
+
+	//	The attack map of the new player is already empty
+	players[id] = player;
+	board.playerCount++;
+
+	//	Adding a player changes the layout and which board representation should be used
+	tables = MoveTables::get(board.size, players, board.playerCount);
+	selectBackend();
+
+	//	Pawns
+	for(size_t x = 0; x < 8; x++)
+		setTile(player.pawnSpawnStart + (player.inverseDirection * x), Tile(PieceName::Pawn, id));
+
+	//	TODO In 4-player chess the queens should appear on tiles that share the same color
+
+	//	King
+	setTile(kingPosition, Tile(PieceName::King, id));
+
+	//	Queen
+	setTile(kingPosition + player.inverseDirection, Tile(PieceName::Queen, id));
+
+	//	Rooks, Bishops and Knights
+	for(int i = 1; i <= 3; i++)
+	{
+		//	Because of the way the enum is ordered, we can initialize these pieces in a loop
+		PieceName piece = static_cast <PieceName> (static_cast <int> (PieceName::Pawn) + i);
+
+		setTile(kingPosition + (player.inverseDirection * (1 + i)), Tile(piece, id));
+		setTile(kingPosition + (player.inverseDirection * (-i)), Tile(piece, id));
+	}
+
+	//	The inputs are relative to the players so every accumulator changes
+	if(network)
+		refreshAccumulator();
+
+	return &players[id];
+}
+
+void Chess::Position::selectBackend()
+{
+	bool useBitBoards = board.size == Vec2s(8, 8) && board.playerCount == 2;
+
+	//	Use an instantiation that knows the size of the board if there is one
+	layout = Layout::Dynamic;
+	if(useBitBoards) layout = Layout::Standard;
+	else if(board.size == Vec2s(12, 8) && board.playerCount == 2) layout = Layout::Wide;
+	else if(board.size == Vec2s(14, 14) && board.playerCount == 4) layout = Layout::FourPlayer;
+
+	if(useBitBoards)
+	{
+		board.bits.clear();
+
+		for(size_t i = 0; i < 2; i++)
+		{
+			board.bits.pawnDirection[i] = players[i].pawnDirection;
+			board.bits.pawnCaptures[i][0] = players[i].pawnDirection + players[i].inverseDirection;
+			board.bits.pawnCaptures[i][1] = players[i].pawnDirection - players[i].inverseDirection;
+		}
+
+		//	Fill the bitboards with the existing pieces
+		for(size_t x = 0; x < board.size.x; x++)
+		{
+			for(size_t y = 0; y < board.size.y; y++)
+				board.bits.set(Vec2s(x, y), Tile(PieceName::None, 0), board.at(Vec2s(x, y)));
+		}
+	}
+
+	//	The attack maps aren't updated when bitboards are used so rebuild them
+	else if(board.useBitBoards)
+	{
+		std::fill(std::begin(board.attacks), std::end(board.attacks), 0);
+		board.useBitBoards = false;
+
+		for(size_t x = 0; x < board.size.x; x++)
+		{
+			for(size_t y = 0; y < board.size.y; y++)
+				updateAttacks(MoveTables::tile(Vec2s(x, y)), +1);
+		}
+	}
+
+	board.useBitBoards = useBitBoards;
+}
+
+bool Chess::Position::threatened(const Vec2s& position, size_t playerID) const
+{
+	return board.threatened(position, playerID);
+}
+
+bool Chess::Position::inCheck(size_t playerID) const
+{
+	return board.threatened(players[playerID].kingPosition, playerID);
+}
+
+Chess::Status Chess::Position::status() const
+{
+	bool check = inCheck(currentPlayer);
+
+	if(hasLegalMove())
+		return check ? Status::Check : Status::Playing;
+
+	return check ? Status::Checkmate : Status::Stalemate;
+}
+
+size_t Chess::Position::mobility(size_t playerID) const
+{
+	if(board.useBitBoards)
+		return board.bits.mobility(playerID);
+
+	MoveList list;
+	size_t result = 0;
+
+	//	Count the pseudo-legal moves of each piece owned by the given player
+	for(size_t x = 0; x < board.size.x; x++)
+	{
+		for(size_t y = 0; y < board.size.y; y++)
+		{
+			Tile t = board.at(Vec2s(x, y));
+			if(t.piece == PieceName::None || t.playerID != playerID)
+				continue;
+
+			list.clear();
+			generateMoves(Vec2s(x, y), false, list);
+			result += list.size();
+		}
+	}
+
+	return result;
+}
+
+void Chess::Position::legalMoves(const Vec2s& position, MoveList& list, bool protectKing)
+{
+	dispatch([&](auto shape) { legalMoves <decltype(shape)> (position, protectKing, list); });
+}
+
+void Chess::Position::legalMoves(const Vec2s& position, MoveList& list, bool protectKing) const
+{
+	//	Moves are made to see if they're legal so that happens on a copy
+	Position copy = *this;
+	copy.legalMoves(position, list, protectKing);
+}
+
+void Chess::Position::generateAllMoves(MoveList& list, bool protectKing)
+{
+	dispatch([&](auto shape) { generateAllMoves <decltype(shape)> (currentPlayer, protectKing, list); });
+}
+
+void Chess::Position::generateAllMoves(MoveList& list, bool protectKing) const
+{
+	Position copy = *this;
+	copy.generateAllMoves(list, protectKing);
+}
+
+size_t Chess::Position::countLegalMoves()
+{
+	return dispatch([this](auto shape) { return countLegalMoves <decltype(shape)> (currentPlayer); });
+}
+
+size_t Chess::Position::countLegalMoves() const
+{
+	Position copy = *this;
+	return copy.countLegalMoves();
+}
+
+bool Chess::Position::hasLegalMove()
+{
+	return dispatch([this](auto shape) { return hasLegalMove <decltype(shape)> (currentPlayer); });
+}
+
+bool Chess::Position::hasLegalMove() const
+{
+	Position copy = *this;
+	return copy.hasLegalMove();
+}
+
+void Chess::Position::promote(PieceName newPiece)
+{
+	//	TODO make sure that newPiece isn't a pawn or a king
+	setTile(board.promotionAt, Tile(newPiece, board.at(board.promotionAt).playerID));
+	board.waitForPromotion = false;
+
+	//	Check if the new piece threatens a king
+	flagThreatenedKings();
+
+	//	Move on to the next player
+	nextTurn(currentPlayer);
+}
+
+void Chess::Position::makeMove(const Move& move, Undo& undo)
+{
+	Vec2s from = move.from();
+	Vec2s to = move.to();
+
+	Tile moved = board.at(from);
+	Player& player = players[moved.playerID];
+
+	//	Save everything that this move could change
+	undo.move = move;
+	undo.moved = moved;
+	undo.castlingRights = castlingRights();
+	undo.doubleSteps = doubleSteps();
+	undo.doubleStepTarget = MoveTables::tile(player.doubleStepTarget);
+	undo.hash = board.hash;
+	undo.waitForPromotion = board.waitForPromotion;
+	undo.promotionAt = MoveTables::tile(board.promotionAt);
+	undo.currentPlayer = currentPlayer;
+
+	//	En passant captures a pawn that isn't on the target tile
+	Vec2s capturedAt = move.is(Move::EnPassant) ? enPassantCapture(moved.playerID, to) : to;
+	Tile captured = board.at(capturedAt);
+
+	undo.capturedAt = MoveTables::tile(capturedAt);
+	undo.captured = captured;
+
+	if(move.is(Move::EnPassant))
+		setTile(capturedAt, Tile(PieceName::None, captured.playerID));
+
+	//	Update the king position and handle castling
+	if(moved.piece == PieceName::King)
+	{
+		player.kingPosition = to;
+		player.kingMoved = true;
+
+		if(move.is(Move::Castling))
+		{
+			//	Get a direction vector pointing towards the rook
+			Vec2i shift = (to.as <int> () - from.as <int> ()) / 2;
+			Vec2s rookPosition = player.rookPosition[castlingSide(player, from, shift)];
+
+			//	Move the rook next to the king on the other side
+			setTile(from + shift, board.at(rookPosition));
+			setTile(rookPosition, Tile(PieceName::None, moved.playerID));
+		}
+	}
+
+	//	Check if rooks have moved
+	else if(moved.piece == PieceName::Rook)
+	{
+		//	Has the kingside rook moved
+		if(from == player.rookPosition[0])
+			player.rookMoved[0] = true;
+
+		//	Has the queenside rook moved
+		else if(from == player.rookPosition[1])
+			player.rookMoved[1] = true;
+	}
+
+	//	A rook that is captured before it moves can't be used for castling
+	if(captured.piece == PieceName::Rook)
+	{
+		Player& victim = players[captured.playerID];
+
+		if(capturedAt == victim.rookPosition[0]) victim.rookMoved[0] = true;
+		else if(capturedAt == victim.rookPosition[1]) victim.rookMoved[1] = true;
+	}
+
+	setTile(to, moved);
+	setTile(from, Tile(PieceName::None, moved.playerID));
+
+	if(move.is(Move::Promotion))
+	{
+		//	If no piece was given, promote() is called later
+		if(move.promotion() == PieceName::None)
+		{
+			board.promotionAt = to;
+			board.waitForPromotion = true;
+		}
+
+		else setTile(to, Tile(move.promotion(), moved.playerID));
+	}
+
+	//	Only the castling rights that changed have to be toggled
+	board.hash ^= Zobrist::castling(undo.castlingRights ^ castlingRights());
+
+	//	The previous double step of this player can't be captured anymore
+	if(player.doubleStepped)
+		board.hash ^= Zobrist::enPassant(player.doubleStepTarget);
+
+	//	If a pawn moved 2 steps, the other players can capture it en passant
+	player.doubleStepped = move.is(Move::DoubleStep);
+	if(player.doubleStepped)
+	{
+		player.doubleStepTarget = from + player.pawnDirection;
+		board.hash ^= Zobrist::enPassant(player.doubleStepTarget);
+	}
+
+	//	Move on to the next player unless a promotion is pending
+	if(!board.waitForPromotion)
+		nextTurn(moved.playerID);
+}
+
+void Chess::Position::unmakeMove(const Undo& undo)
+{
+	Vec2s from = undo.move.from();
+	Vec2s to = undo.move.to();
+	Vec2s capturedAt = MoveTables::position(undo.capturedAt);
+
+	Tile moved = undo.moved;
+	Player& player = players[moved.playerID];
+
+	//	Put the rook back to where it was before castling
+	if(undo.move.is(Move::Castling))
+	{
+		Vec2i shift = (to.as <int> () - from.as <int> ()) / 2;
+
+		Vec2s rookPosition = player.rookPosition[castlingSide(player, from, shift)];
+		setTile(rookPosition, board.at(from + shift));
+		setTile(from + shift, Tile(PieceName::None, moved.playerID));
+	}
+
+	//	Restore the moved piece and whatever was captured
+	setTile(from, moved);
+
+	if(capturedAt == to)
+		setTile(to, undo.captured);
+
+	else
+	{
+		setTile(to, Tile(PieceName::None, moved.playerID));
+		setTile(capturedAt, undo.captured);
+	}
+
+	//	Only moves of the king change where it is
+	if(moved.piece == PieceName::King)
+		player.kingPosition = from;
+
+	setCastlingRights(undo.castlingRights);
+	setDoubleSteps(undo.doubleSteps);
+	player.doubleStepTarget = MoveTables::position(undo.doubleStepTarget);
+
+	board.waitForPromotion = undo.waitForPromotion;
+	board.promotionAt = MoveTables::position(undo.promotionAt);
+	board.hash = undo.hash;
+	currentPlayer = undo.currentPlayer;
+}
+
+size_t Chess::Position::castlingSide(const Player& player, const Vec2s& kingPosition, const Vec2i& direction) const
+{
+	//	The rooks are on opposite sides of the king so checking the queenside is enough
+	Vec2i toRook = player.rookPosition[1].as <int> () - kingPosition.as <int> ();
+	Vec2i queenSide((toRook.x > 0) - (toRook.x < 0), (toRook.y > 0) - (toRook.y < 0));
+
+	return queenSide == direction;
+}
+
+void Chess::Position::nextTurn(size_t playerID)
+{
+	board.hash ^= Zobrist::turn(currentPlayer);
+	currentPlayer = (playerID + 1) % board.playerCount;
+	board.hash ^= Zobrist::turn(currentPlayer);
+
+	//	Pawns of this player that moved 2 steps can't be captured en passant anymore
+	Player& player = players[currentPlayer];
+	if(player.doubleStepped)
+	{
+		player.doubleStepped = false;
+		board.hash ^= Zobrist::enPassant(player.doubleStepTarget);
+	}
+}
+
+uint32_t Chess::Position::castlingRights() const
+{
+	uint32_t rights = 0;
+
+	for(size_t i = 0; i < board.playerCount; i++)
+	{
+		rights |= (	players[i].kingMoved << 0 |
+					players[i].rookMoved[0] << 1 |
+					players[i].rookMoved[1] << 2) << (i * 3);
+	}
+
+	return rights;
+}
+
+uint32_t Chess::Position::doubleSteps() const
+{
+	uint32_t steps = 0;
+
+	for(size_t i = 0; i < board.playerCount; i++)
+		steps |= players[i].doubleStepped << i;
+
+	return steps;
+}
+
+void Chess::Position::setDoubleSteps(uint32_t steps)
+{
+	for(size_t i = 0; i < board.playerCount; i++)
+		players[i].doubleStepped = steps >> i & 1;
+}
+
+void Chess::Position::setCastlingRights(uint32_t rights)
+{
+	for(size_t i = 0; i < board.playerCount; i++)
+	{
+		players[i].kingMoved = rights >> (i * 3 + 0) & 1;
+		players[i].rookMoved[0] = rights >> (i * 3 + 1) & 1;
+		players[i].rookMoved[1] = rights >> (i * 3 + 2) & 1;
+	}
+}
+
+template <typename S>
+Chess::Position::Pins Chess::Position::findPins(size_t playerID) const
+{
+	Pins pins;
+	const Vec2s& king = players[playerID].kingPosition;
+	Tile t = board.at(king);
+
+	//	Every move is tested if the king is threatened or if there's no king
+	if(t.piece != PieceName::King || t.playerID != playerID || board.threatened <S> (king, playerID))
+		return pins;
+
+	pins.check = false;
+	unsigned origin = MoveTables::tile(king);
+
+	for(size_t d = 0; d < 8; d++)
+	{
+		const MoveTables::Ray& ray = tables->ray(origin, d);
+		size_t shield = ray.length;
+
+		for(size_t i = 0; i < ray.length; i++)
+		{
+			Tile blocker = board.at(ray.tiles[i]);
+			if(blocker.piece == PieceName::None)
+				continue;
+
+			//	If there are 2 pieces of this player on the ray, neither is pinned
+			if(blocker.playerID == playerID)
+			{
+				if(shield < ray.length)
+					break;
+
+				shield = i;
+				continue;
+			}
+
+			//	The first enemy ends the ray. It pins the shield if it slides in this direction
+			bool slides = blocker.piece == PieceName::Queen || blocker.piece == (d < 4 ? PieceName::Rook : PieceName::Bishop);
+			if(slides && shield < ray.length)
+				pins.tiles[pins.count++] = ray.tiles[shield];
+
+			break;
+		}
+	}
+
+	return pins;
+}
+
+bool Chess::Position::needsTest(const Pins& pins, const Vec2s& position) const
+{
+	return pins.check || board.at(position).piece == PieceName::King || pins.pinned(MoveTables::tile(position));
+}
+
+template <typename S>
+void Chess::Position::generateAllMoves(size_t playerID, bool protectKing, MoveList& list)
+{
+	size_t width = S::width(board.size);
+	size_t height = S::height(board.size);
+
+	//	Pins aren't needed for pseudo-legal moves
+	Pins pins;
+	if(protectKing)
+		pins = findPins <S> (playerID);
+
+	for(size_t x = 0; x < width; x++)
+	{
+		for(size_t y = 0; y < height; y++)
+		{
+			Tile t = board.at(Vec2s(x, y));
+			if(t.piece == PieceName::None || t.playerID != playerID)
+				continue;
+
+			if(protectKing) legalMoves <S> (Vec2s(x, y), pins, list);
+			else generateMoves(Vec2s(x, y), false, list);
+		}
+	}
+
+#ifdef DEBUG
+	/*	Lists of single pieces can't overflow but all the moves of a crowded
+	 *	board can. The search and the status would then miss moves silently */
+	assert(!list.overflowed());
+#endif
+}
+
+template <typename S>
+void Chess::Position::legalMoves(const Vec2s& position, bool protectKing, MoveList& list)
+{
+	if(!protectKing)
+	{
+		generateMoves(position, false, list);
+		return;
+	}
+
+	legalMoves <S> (position, findPins <S> (board.at(position).playerID), list);
+}
+
+template <typename S>
+void Chess::Position::legalMoves(const Vec2s& position, const Pins& pins, MoveList& list)
+{
+	//	Moves of this piece start from here
+	size_t first = list.size();
+	generateMoves(position, true, list);
+
+	size_t kept = first;
+	bool test = needsTest(pins, position);
+	bool check = false;
+
+	//	If a move leads to checking the current player, don't reveal it
+	for(size_t i = first; i < list.size(); i++)
+	{
+		if(!test && !list[i].is(Move::EnPassant))
+		{
+			list[kept++] = list[i];
+			continue;
+		}
+
+		//	Promotions to different pieces share the same outcome
+		if(i == first || list[i].to() != list[i - 1].to())
+			check = leadsToCheck <S> (list[i]);
+
+		if(!check)
+			list[kept++] = list[i];
+	}
+
+	list.resize(kept);
+}
+
+template <typename S>
+size_t Chess::Position::countLegalMoves(size_t playerID)
+{
+	size_t width = S::width(board.size);
+	size_t height = S::height(board.size);
+
+	Pins pins = findPins <S> (playerID);
+	size_t count = 0;
+	MoveList list;
+
+	for(size_t x = 0; x < width; x++)
+	{
+		for(size_t y = 0; y < height; y++)
+		{
+			Vec2s position(x, y);
+			Tile t = board.at(position);
+
+			if(t.piece == PieceName::None || t.playerID != playerID)
+				continue;
+
+			//	Every attacked tile is a legal move for pieces that don't need testing
+			if(	(S::bitBoards || (S::dynamic && board.useBitBoards)) && t.piece != PieceName::Pawn &&
+				!needsTest(pins, position))
+			{
+				uint64_t targets = board.bits.attacks(t.piece, playerID, BitBoard::bit(position));
+				count += __builtin_popcountll(targets & ~board.bits.players[playerID]);
+				continue;
+			}
+
+			list.clear();
+			legalMoves <S> (position, pins, list);
+			count += list.size();
+		}
+	}
+
+	return count;
+}
+
+void Chess::Position::generateMoves(const Vec2s& position, bool protectKing, MoveList& list) const
+{
+	if(board.useBitBoards)
+	{
+		generateBitBoardMoves(position, protectKing, list);
+		return;
+	}
+
+	Tile t = board.at(position);
+	unsigned origin = MoveTables::tile(position);
+
+	auto reveal = [this, &list, &position, &t](unsigned target)
+	{
+		//	Reveal a movement or a capture if the tile has an enemy
+		if(!board.occupied(target))
+			list.add(Move(position, MoveTables::position(target)));
+
+		else if(board.at(target).playerID != t.playerID)
+			list.add(Move(position, MoveTables::position(target), Move::Capture));
+	};
+
+	//	Which directions can the piece slide to
+	size_t first = 0;
+	size_t last = 0;
+
+	switch(t.piece)
+	{
+		case PieceName::Pawn:
+		{
+			//	Pseudo-legal moves only include tiles that the piece attacks
+			if(protectKing)
+				addEnPassantMoves(t.playerID, position, list);
+
+			//	If a normal capture can be made, reveal it
+			for(unsigned side : tables->pawnCaptures(t.playerID, origin))
+			{
+				if(board.occupied(side) && t.playerID != board.at(side).playerID)
+					addPawnMove(list, position, MoveTables::position(side), Move::Capture);
+			}
+
+			//	Move the pawn and make sure that it could actually move
+			for(unsigned once : tables->pawnPush(t.playerID, origin))
+			{
+				if(board.occupied(once))
+					break;
+
+				addPawnMove(list, position, MoveTables::position(once), 0);
+
+				//	Pawns that haven't moved can move 2 steps
+				if(!tables->pawnIs(t.playerID, origin, MoveTables::OnSpawn))
+					break;
+
+				for(unsigned twice : tables->pawnPush(t.playerID, once))
+				{
+					if(!board.occupied(twice))
+						addPawnMove(list, position, MoveTables::position(twice), Move::DoubleStep);
+				}
+			}
+
+			return;
+		}
+
+		case PieceName::Rook: last = 4; break;
+		case PieceName::Bishop: first = 4; last = 8; break;
+		case PieceName::Queen: last = 8; break;
+
+		case PieceName::King:
+		{
+			//	Pseudo-legal moves only include tiles that the piece attacks
+			if(protectKing)
+				addCastlingMoves(t.playerID, position, list);
+
+			for(unsigned target : tables->king(origin))
+				reveal(target);
+
+			return;
+		}
+
+		case PieceName::Knight:
+		{
+			for(unsigned target : tables->knight(origin))
+				reveal(target);
+
+			return;
+		}
+
+		case PieceName::None: return;
+	}
+
+	//	Slide until the edge of the board or until something is in the way
+	for(size_t i = first; i < last; i++)
+	{
+		const MoveTables::Ray& ray = tables->ray(origin, i);
+
+		for(size_t j = 0; j < ray.length; j++)
+		{
+			reveal(ray.tiles[j]);
+
+			if(board.occupied(ray.tiles[j]))
+				break;
+		}
+	}
+}
+
+void Chess::Position::generateBitBoardMoves(const Vec2s& position, bool protectKing, MoveList& list) const
+{
+	Tile t = board.at(position);
+	const BitBoard& bits = board.bits;
+
+	uint64_t origin = BitBoard::bit(position);
+	uint64_t own = bits.players[t.playerID];
+	uint64_t enemy = bits.players[!t.playerID];
+	uint64_t targets = 0;
+
+	switch(t.piece)
+	{
+		case PieceName::Pawn:
+		{
+			const Player& player = players[t.playerID];
+			uint64_t empty = ~bits.occupied();
+
+			//	Pawns on the spawn line can move 2 steps if nothing blocks them
+			uint64_t single = BitBoard::shift(origin, player.pawnDirection) & empty;
+			uint64_t twice = 0;
+
+			if(tables->pawnIs(t.playerID, MoveTables::tile(position), MoveTables::OnSpawn))
+				twice = BitBoard::shift(single, player.pawnDirection) & empty;
+
+			if(single) addPawnMove(list, position, BitBoard::position(__builtin_ctzll(single)), 0);
+			if(twice) addPawnMove(list, position, BitBoard::position(__builtin_ctzll(twice)), Move::DoubleStep);
+
+			//	Normal captures
+			for(uint64_t captures = bits.pawnAttacks(origin, t.playerID) & enemy; captures; captures &= captures - 1)
+				addPawnMove(list, position, BitBoard::position(__builtin_ctzll(captures)), Move::Capture);
+
+			//	Pseudo-legal moves only include tiles that the piece attacks
+			if(protectKing)
+				addEnPassantMoves(t.playerID, position, list);
+
+			return;
+		}
+
+		case PieceName::King:
+		{
+			//	Pseudo-legal moves only include tiles that the piece attacks
+			if(protectKing)
+				addCastlingMoves(t.playerID, position, list);
+
+			targets = BitBoard::kingAttacks(origin) & ~own;
+			break;
+		}
+
+		case PieceName::None: return;
+		default: targets = bits.attacks(t.piece, t.playerID, origin) & ~own; break;
+	}
+
+	//	Reveal every tile the piece can reach
+	for(; targets; targets &= targets - 1)
+	{
+		uint64_t target = targets & -targets;
+		uint32_t flags = (target & enemy) ? static_cast <uint32_t> (Move::Capture) : 0;
+
+		list.add(Move(position, BitBoard::position(__builtin_ctzll(target)), flags));
+	}
+}
+
+void Chess::Position::addEnPassantMoves(size_t playerID, const Vec2s& position, MoveList& list) const
+{
+	//	En passante could be possible if this pawn is on the 5th rank
+	if(!tables->pawnIs(playerID, MoveTables::tile(position), MoveTables::EnPassantRank))
+		return;
+
+	const Player& player = players[playerID];
+	const Vec2i directions[]
+	{
+		player.pawnDirection,
+		player.inverseDirection,
+		player.inverseDirection * -1
+	};
+
+	for(auto& dir : directions)
+	{
+		Vec2s capturePosition = position;
+
+		//	If en passante is possible, reveal the capture
+		if(canEnPassante(playerID, capturePosition, dir))
+			list.add(Move(position, capturePosition, Move::Capture | Move::EnPassant));
+	}
+}
+
+void Chess::Position::addCastlingMoves(size_t playerID, const Vec2s& position, MoveList& list) const
+{
+	const Player& player = players[playerID];
+
+	//	Try castling if king isn't being threated and it hasn't moved
+	if(player.kingMoved || board.threatened(player.kingPosition, playerID))
+		return;
+
+	Vec2s queenSide = position;
+	Vec2s kingSide = position;
+
+	//	Can the king castle on kingside
+	if(canCastle(playerID, kingSide, false))
+		list.add(Move(position, kingSide, Move::Castling));
+
+	//	Can the king castle on queenside
+	if(canCastle(playerID, queenSide, true))
+		list.add(Move(position, queenSide, Move::Castling));
+}
+
+void Chess::Position::addPawnMove(MoveList& list, const Vec2s& from, const Vec2s& to, uint32_t flags) const
+{
+	//	A pawn reaching the other side of the board can promote to any of these
+	if(tables->pawnIs(board.at(from).playerID, MoveTables::tile(to), MoveTables::Promotes))
+	{
+		flags |= Move::Promotion;
+
+		list.add(Move(from, to, flags, PieceName::Queen));
+		list.add(Move(from, to, flags, PieceName::Rook));
+		list.add(Move(from, to, flags, PieceName::Bishop));
+		list.add(Move(from, to, flags, PieceName::Knight));
+	}
+
+	else list.add(Move(from, to, flags));
+}
+
+template <typename S>
+bool Chess::Position::leadsToCheck(const Move& move)
+{
+	size_t playerID = board.at(move.from()).playerID;
+
+	//	Perform a fake move
+	Undo undo;
+	makeMove(move, undo);
+
+	//	Is the king of the moving player threatened
+	bool result = board.threatened <S> (players[playerID].kingPosition, playerID);
+
+	//	Reset the old state
+	unmakeMove(undo);
+	return result;
+}
+
+void Chess::Position::flagThreatenedKings()
+{
+	//	The attack maps are always up to date so checks are just lookups
+	for(size_t i = 0; i < board.playerCount; i++)
+		players[i].kingThreatened = board.threatened(players[i].kingPosition, i);
+}
+
+template <typename S>
+bool Chess::Position::hasLegalMove(size_t playerID)
+{
+	size_t width = S::width(board.size);
+	size_t height = S::height(board.size);
+
+	Pins pins = findPins <S> (playerID);
+	MoveList list;
+
+	for(size_t x = 0; x < width; x++)
+	{
+		for(size_t y = 0; y < height; y++)
+		{
+			Tile originTile = board.at(Vec2s(x, y));
+
+			//	Ignore tiles that don't have a piece of this player
+			if(originTile.piece == PieceName::None || originTile.playerID != playerID)
+				continue;
+
+			list.clear();
+			generateMoves(Vec2s(x, y), true, list);
+			bool test = needsTest(pins, Vec2s(x, y));
+
+			//	One legal move is enough
+			for(auto& m : list)
+			{
+				if((!test && !m.is(Move::EnPassant)) || !leadsToCheck <S> (m))
+					return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void Chess::Position::setTile(const Vec2s& position, Tile tile)
+{
+	Tile old = board.at(position);
+	unsigned index = MoveTables::tile(position);
+
+	board.hash ^= Zobrist::piece(old, position) ^ Zobrist::piece(tile, position);
+	board.scores[old.playerID] -= tables->pieceSquare(old.piece, index);
+	board.scores[tile.playerID] += tables->pieceSquare(tile.piece, index);
+
+	if(network)
+		updateAccumulator(index, old, tile);
+
+	//	Bitboards don't need attack maps
+	if(board.useBitBoards)
+	{
+		board.bits.set(position, old, tile);
+		board.set(position, tile);
+		return;
+	}
+
+	bool wasOccupied = old.piece != PieceName::None;
+	bool willBeOccupied = tile.piece != PieceName::None;
+
+	//	The old piece no longer attacks anything from here
+	if(wasOccupied)
+		updateAttacks(index, -1);
+
+	/*	If the occupation of this tile changes, sliding pieces that can see
+	 *	this tile either get blocked or can see further than before */
+	if(wasOccupied != willBeOccupied)
+	{
+		for(size_t i = 0; i < 8; i++)
+		{
+			bool slant = i >= 4;
+			const MoveTables::Ray& ray = tables->ray(index, i);
+
+			//	Find the closest piece in this direction
+			size_t j = 0;
+			while(j < ray.length && !board.occupied(ray.tiles[j]))
+				j++;
+
+			if(j == ray.length)
+				continue;
+
+			Tile slider = board.at(ray.tiles[j]);
+
+			//	Only pieces that slide towards this tile are affected
+			if(	slider.piece == PieceName::Queen ||
+				(slider.piece == PieceName::Rook && !slant) ||
+				(slider.piece == PieceName::Bishop && slant))
+			{
+				//	The ray continues past this tile in the opposite direction
+				updateRay(index, i ^ 3, slider.playerID, willBeOccupied ? -1 : +1);
+			}
+		}
+	}
+
+	board.set(position, tile);
+
+	//	The new piece attacks from here
+	if(willBeOccupied)
+		updateAttacks(index, +1);
+}
+
+void Chess::Position::updateAccumulator(unsigned tile, Tile old, Tile current)
+{
+	size_t count = board.playerCount;
+
+	//	Each player sees the tile and the owner relative to themselves
+	for(size_t i = 0; i < count; i++)
+	{
+		unsigned relative = tables->relativeTile(i, tile);
+
+		if(old.piece != PieceName::None)
+			network->remove(board.accumulator, i, Network::feature(old.piece, (old.playerID + count - i) % count, relative));
+
+		if(current.piece != PieceName::None)
+			network->add(board.accumulator, i, Network::feature(current.piece, (current.playerID + count - i) % count, relative));
+	}
+}
+
+void Chess::Position::refreshAccumulator()
+{
+	for(size_t i = 0; i < board.playerCount; i++)
+		network->clear(board.accumulator, i);
+
+	for(size_t x = 0; x < board.size.x; x++)
+	{
+		for(size_t y = 0; y < board.size.y; y++)
+		{
+			unsigned tile = MoveTables::tile(Vec2s(x, y));
+			updateAccumulator(tile, Tile(PieceName::None, 0), board.at(tile));
+		}
+	}
+}
+
+void Chess::Position::setNetwork(const Network* network)
+{
+	this->network = network;
+	if(network)
+		refreshAccumulator();
+}
+
+void Chess::Position::updateAttacks(unsigned tile, int change)
+{
+	Tile t = board.at(tile);
+
+	switch(t.piece)
+	{
+		case PieceName::Pawn:
+		{
+			for(unsigned target : tables->pawnCaptures(t.playerID, tile))
+				board.attacksAt(t.playerID, target) += change;
+
+			return;
+		}
+
+		case PieceName::Knight:
+		{
+			for(unsigned target : tables->knight(tile))
+				board.attacksAt(t.playerID, target) += change;
+
+			return;
+		}
+
+		case PieceName::King:
+		{
+			for(unsigned target : tables->king(tile))
+				board.attacksAt(t.playerID, target) += change;
+
+			return;
+		}
+
+		case PieceName::Rook:
+		case PieceName::Bishop:
+		case PieceName::Queen:
+		{
+			size_t i = t.piece == PieceName::Bishop ? 4 : 0;
+			size_t limit = t.piece == PieceName::Rook ? 4 : 8;
+
+			for(; i < limit; i++)
+				updateRay(tile, i, t.playerID, change);
+
+			return;
+		}
+
+		case PieceName::None: return;
+	}
+}
+
+void Chess::Position::updateRay(unsigned tile, size_t direction, size_t playerID, int change)
+{
+	const MoveTables::Ray& ray = tables->ray(tile, direction);
+
+	//	Walk until the ray hits the edge of the board or a piece that blocks it
+	for(size_t i = 0; i < ray.length; i++)
+	{
+		board.attacksAt(playerID, ray.tiles[i]) += change;
+
+		if(board.occupied(ray.tiles[i]))
+			return;
+	}
+}
+
+bool Chess::Position::canCastle(size_t playerID, Vec2s& position, bool queenSide) const
+{
+	const Player& player = players[playerID];
+	Vec2s rookPosition = player.rookPosition[queenSide];
+
+	//	If the rook on the given side has moved, no castling can happen
+	if(	player.rookMoved[queenSide] || board.at(rookPosition).piece != PieceName::Rook ||
+		board.at(rookPosition).playerID != playerID)
+	{
+		return false;
+	}
+
+	//	Get a direction vector pointing towards the rook
+	Vec2i toRook = rookPosition.as <int> () - position.as <int> ();
+	Vec2i direction((toRook.x > 0) - (toRook.x < 0), (toRook.y > 0) - (toRook.y < 0));
+
+	//	Every tile between the king and the rook has to be empty
+	for(Vec2s current = position + direction; current != rookPosition; current += direction)
+	{
+		if(board.occupied(current))
+			return false;
+	}
+
+	/*	The king can't move through or to a threatened tile. The king isn't
+	 *	threatened so it can't block an attack on those tiles either */
+	for(size_t i = 0; i < 2; i++)
+	{
+		position += direction;
+
+		if(board.threatened(position, playerID))
+			return false;
+	}
+
+	return true;
+}
+
+bool Chess::Position::canEnPassante(size_t playerID, Vec2s& position, Vec2i direction) const
+{
+	//	Is the adjacent position inside the board
+	Vec2s adjacentPosition = position + direction;
+	if(!board.isInside(adjacentPosition))
+		return false;
+
+	Tile t = board.at(adjacentPosition);
+
+	//	If the adjacent piece isn't a pawn or not an enemy, en passante can't happen
+	if(t.piece != PieceName::Pawn || t.playerID == playerID)
+		return false;
+
+	//	The enemy has to have moved this pawn 2 steps on their last turn
+	const Player& enemy = players[t.playerID];
+	if(!enemy.doubleStepped || enemy.doubleStepTarget + enemy.pawnDirection != adjacentPosition)
+		return false;
+
+	position = enemy.doubleStepTarget;
+	return true;
+}
+
+Vec2s Chess::Position::enPassantCapture(size_t playerID, const Vec2s& target) const
+{
+	//	Find whose pawn skipped the target tile
+	for(size_t i = 0; i < board.playerCount; i++)
+	{
+		if(i != playerID && players[i].doubleStepped && players[i].doubleStepTarget == target)
+			return target + players[i].pawnDirection;
+	}
+
+	return target;
+}
+
+void Chess::Position::Board::set(const Vec2s& position, Tile tile)
+{
+	data[MoveTables::tile(position)] = tile;
+}
+
+template <typename S>
+bool Chess::Position::Board::threatened(const Vec2s& position, size_t playerID) const
+{
+	if(S::bitBoards || (S::dynamic && useBitBoards))
+		return bits.attacked(position, !playerID);
+
+	unsigned tile = MoveTables::tile(position);
+	size_t count = S::players(playerCount);
+
+	//	Is the given tile attacked by anyone else than the given player
+	for(size_t i = 0; i < count; i++)
+	{
+		if(i != playerID && attacksAt(i, tile) > 0)
+			return true;
+	}
+
+	return false;
+}
+
+bool Chess::Position::Board::occupied(const Vec2s& position) const
+{
+	return at(position).piece != PieceName::None;
+}
+
+bool Chess::Position::Board::isInside(const Vec2s& position) const
+{
+	return	position >= Vec2s () && position < size;
+}
@@ -0,0 +1,293 @@
+#ifndef CHESS_POSITION_HEADER
+#define CHESS_POSITION_HEADER
+
+#include "../Vector2.hh"
+#include "Player.hh"
+#include "Piece.hh"
+#include "Move.hh"
+#include "BitBoard.hh"
+#include "Zobrist.hh"
+#include "MoveTables.hh"
+#include "Network.hh"
+#include "Shape.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace Chess
+{
+
+//	The state of the game from the perspective of the current player
+enum class Status
+{
+	Playing,
+	Check,
+	Checkmate,
+	Stalemate
+};
+
+/*	Position contains everything that decides what can happen next in a game:
+ *	the pieces, the players and whose turn it is. It doesn't point to anything
+ *	that it owns so copying a position is a single memcpy.
+ *
+ *	The const functions don't modify the position, so any number of threads can
+ *	read the same snapshot. Checking if moves are legal requires making them,
+ *	so the const variants of the move generators work on a private copy while
+ *	the non-const variants make and revert the moves in place */
+class Position
+{
+public:
+	/*	Undo holds everything that makeMove() changes so that unmakeMove()
+	 *	can restore the state without copying the position. Tiles are stored
+	 *	like in MoveTables so that a whole game can be kept as a history */
+	struct Undo
+	{
+		uint64_t hash;
+		Move move;
+
+		PackedTile moved;
+		PackedTile captured;
+		uint8_t capturedAt;
+
+		//	Bits 3n to 3n + 2 contain kingMoved and rookMoved of player n
+		uint16_t castlingRights;
+
+		//	Bit n is set if player n has doubleStepped set
+		uint8_t doubleSteps;
+		uint8_t doubleStepTarget;
+
+		bool waitForPromotion;
+		uint8_t promotionAt;
+		uint8_t currentPlayer;
+	};
+
+	Position() {}
+
+	//	The board can be at most 16x16. Larger sizes throw std::invalid_argument
+	Position(size_t boardWidth, size_t boardHeight);
+
+	/*	Other layouts than 8x8 with two players use an extended notation
+	 *
+	 *		@12x8 +yc1j1,-yc8j8 2R1N1B1K1Q1B1N1R12/... 0 kq,kq -
+	 *
+	 *	After the board size, each player is given as the direction that their
+	 *	pawns move to and where their kingside and queenside rooks start. Pieces
+	 *	are uppercase letters followed by the owner, the turn is a player number,
+	 *	castling rights are listed for each player and en passant targets are
+	 *	prefixed by the player whose pawn can be captured */
+	static const size_t maxFENLength = 768;
+
+	/*	fromFEN() replaces the position with the one described by the given FEN
+	 *	or extended notation. With standard FEN the first player is white. Returns
+	 *	false if the string is malformed in which case the position is unknown */
+	bool fromFEN(const char* fen);
+
+	/*	toFEN() writes the position to the given buffer and returns the length of
+	 *	the text. Standard FEN is used when the layout allows it. If the text
+	 *	doesn't fit, nothing is written and 0 is returned */
+	size_t toFEN(char* buffer, size_t size) const;
+
+	/*	There can be at most MoveTables::maxPlayers players. Returns
+	 *	nullptr without changing the position when there's no room */
+	Player* addPlayer(const Vec2s& kingPosition, const Vec2s& middle);
+
+	Tile at(const Vec2s& position) const { return board.at(position); }
+	bool isInside(const Vec2s& position) const { return board.isInside(position); }
+
+	size_t getCurrentTurn() const { return currentPlayer; }
+	size_t getPlayerCount() const { return board.playerCount; }
+	const Player& getPlayer(size_t playerID) const { return players[playerID]; }
+	void setBot(size_t playerID, bool isBot) { players[playerID].isBot = isBot; }
+	Vec2s getBoardSize() const { return board.size; }
+
+	bool waitsForPromotion() const { return board.waitForPromotion; }
+	Vec2s getPromotion() const { return board.promotionAt; }
+
+	/*	hash() returns the Zobrist hash of the position. It covers the pieces,
+	 *	castling rights, pawns that can be captured en passant and the player
+	 *	whose turn it is */
+	uint64_t hash() const { return board.hash; }
+
+	/*	pieceScore() returns the sum of MoveTables::pieceSquare() over the pieces
+	 *	of the given player. It's updated as pieces move so reading it is free */
+	int pieceScore(size_t playerID) const { return board.scores[playerID]; }
+
+	/*	setNetwork() makes the position keep accumulators of the given network
+	 *	up to date. The network has to outlive the position. nullptr stops that */
+	void setNetwork(const Network* network);
+	const Network* getNetwork() const { return network; }
+
+	//	networkScore() returns the network evaluation from the perspective of the given player
+	int networkScore(size_t playerID) const { return network->evaluate(board.accumulator, playerID); }
+
+	//	Is the given tile attacked by anyone else than the given player
+	bool threatened(const Vec2s& position, size_t playerID) const;
+
+	//	Is the king of the given player threatened
+	bool inCheck(size_t playerID) const;
+
+	//	status() tells if the current player is checkmated or stalemated
+	Status status() const;
+
+	//	How many tiles the pieces of the given player could move to
+	size_t mobility(size_t playerID) const;
+
+	//	legalMoves() appends the moves of the piece at the given position to the list
+	void legalMoves(const Vec2s& position, MoveList& list, bool protectKing = true);
+	void legalMoves(const Vec2s& position, MoveList& list, bool protectKing = true) const;
+
+	/*	generateAllMoves() appends the moves of every piece of the current player to
+	 *	the list. Checks and pins are found once, so only the moves that could leave
+	 *	the king threatened have to be made to see if they're legal */
+	void generateAllMoves(MoveList& list, bool protectKing = true);
+	void generateAllMoves(MoveList& list, bool protectKing = true) const;
+
+	/*	countLegalMoves() returns how many moves generateAllMoves() would give.
+	 *	With bitboards the moves of most pieces are counted without listing them */
+	size_t countLegalMoves();
+	size_t countLegalMoves() const;
+
+	//	Does the current player have any legal moves
+	bool hasLegalMove();
+	bool hasLegalMove() const;
+
+	/*	makeMove() applies a move generated by legalMoves() and stores what's
+	 *	needed to revert it with unmakeMove(). Moves have to be reverted in the
+	 *	reverse order. This doesn't update kingThreatened of the players */
+	void makeMove(const Move& move, Undo& undo);
+	void unmakeMove(const Undo& undo);
+
+	//	promote() replaces the pawn that is waiting for promotion
+	void promote(PieceName newPiece);
+
+	//	Updates kingThreatened of each player
+	void flagThreatenedKings();
+
+private:
+	struct Board
+	{
+		bool occupied(const Vec2s& position) const;
+		bool isInside(const Vec2s& position) const;
+		bool threatened(const Vec2s& position, size_t playerID) const { return threatened <DynamicShape> (position, playerID); }
+		template <typename S> bool threatened(const Vec2s& position, size_t playerID) const;
+
+		Tile at(const Vec2s& position) const { return data[MoveTables::tile(position)]; }
+		Tile at(unsigned tile) const { return data[tile]; }
+		bool occupied(unsigned tile) const { return data[tile].piece() != PieceName::None; }
+		void set(const Vec2s& position, Tile tile);
+		unsigned char& attacksAt(size_t playerID, unsigned tile) { return attacks[maxTiles * playerID + tile]; }
+		unsigned char attacksAt(size_t playerID, unsigned tile) const { return attacks[maxTiles * playerID + tile]; }
+
+		//	Moves store tiles in 8 bits so boards can't be larger than 16x16
+		static const size_t maxTiles = MoveTables::maxTiles;
+
+		/*	The tiles are stored inline so that copying a board doesn't allocate.
+		 *	They're indexed like in MoveTables so that the tables can be used directly */
+		PackedTile data[maxTiles];
+
+		/*	For each player, how many of their pieces attack each tile. These
+		 *	are kept up to date by setTile() so that checks are simple lookups */
+		unsigned char attacks[Zobrist::maxPlayers * maxTiles] {};
+		size_t playerCount = 0;
+
+		/*	8x8 boards with two players also keep bitboards. When
+		 *	those are used, the attack maps aren't kept up to date */
+		BitBoard bits;
+		bool useBitBoards = false;
+
+		bool waitForPromotion = false;
+		Vec2s promotionAt;
+
+		//	Updated by setTile() and makeMove() as the position changes
+		uint64_t hash = 0;
+
+		//	Updated by setTile() like the hash
+		int scores[Zobrist::maxPlayers] {};
+		Network::Accumulator accumulator;
+
+		Vec2s size;
+	};
+
+	/*	Layouts that are used a lot have their own instantiations of the functions
+	 *	that loop over the board or the players. dispatch() calls the given function
+	 *	with the Shape of the current layout */
+	enum class Layout
+	{
+		Dynamic,
+		Standard,
+		Wide,
+		FourPlayer
+	};
+
+	template <typename F> auto dispatch(F&& function) const;
+
+	/*	Pins tells which moves have to be made to see if they're legal. A move
+	 *	can only leave the king threatened if the king is already threatened, if
+	 *	the king moves or if the piece is the only thing between the king and an
+	 *	attacker. En passant removes another piece so it's always tested too */
+	struct Pins
+	{
+		bool check = true;
+
+		uint8_t count = 0;
+		uint8_t tiles[8];
+
+		bool pinned(unsigned tile) const { return std::find(tiles, tiles + count, tile) != tiles + count; }
+	};
+
+	template <typename S> Pins findPins(size_t playerID) const;
+	bool needsTest(const Pins& pins, const Vec2s& position) const;
+
+	template <typename S> void generateAllMoves(size_t playerID, bool protectKing, MoveList& list);
+	template <typename S> void legalMoves(const Vec2s& position, bool protectKing, MoveList& list);
+	template <typename S> void legalMoves(const Vec2s& position, const Pins& pins, MoveList& list);
+	template <typename S> size_t countLegalMoves(size_t playerID);
+	template <typename S> bool leadsToCheck(const Move& move);
+	template <typename S> bool hasLegalMove(size_t playerID);
+
+	void selectBackend();
+
+	bool fromExtendedFEN(const char* fen);
+	bool parsePlacement(const char*& fen, bool extended);
+	bool standardLayout() const;
+
+	void setTile(const Vec2s& position, Tile tile);
+	void updateAccumulator(unsigned tile, Tile old, Tile current);
+	void refreshAccumulator();
+	void updateAttacks(unsigned tile, int change);
+	void updateRay(unsigned tile, size_t direction, size_t playerID, int change);
+
+	bool canCastle(size_t playerID, Vec2s& position, bool queenSide) const;
+	bool canEnPassante(size_t playerID, Vec2s& position, Vec2i direction) const;
+	Vec2s enPassantCapture(size_t playerID, const Vec2s& target) const;
+
+	void generateMoves(const Vec2s& position, bool protectKing, MoveList& list) const;
+	void generateBitBoardMoves(const Vec2s& position, bool protectKing, MoveList& list) const;
+	void addEnPassantMoves(size_t playerID, const Vec2s& position, MoveList& list) const;
+	void addCastlingMoves(size_t playerID, const Vec2s& position, MoveList& list) const;
+	void addPawnMove(MoveList& list, const Vec2s& from, const Vec2s& to, uint32_t flags) const;
+
+	void nextTurn(size_t playerID);
+	size_t castlingSide(const Player& player, const Vec2s& kingPosition, const Vec2i& direction) const;
+
+	uint32_t castlingRights() const;
+	void setCastlingRights(uint32_t rights);
+
+	uint32_t doubleSteps() const;
+	void setDoubleSteps(uint32_t steps);
+
+	Board board;
+	Player players[MoveTables::maxPlayers];
+	size_t currentPlayer = 0;
+
+	Layout layout = Layout::Dynamic;
+
+	//	Tables are never freed so every position can point to them
+	const MoveTables* tables = nullptr;
+	const Network* network = nullptr;
+};
+
+}
+
+#endif
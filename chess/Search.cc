@@ -0,0 +1,432 @@
+#include "Search.hh"
+#include "Game.hh"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+Chess::SearchResult Chess::Search::run(Game& game, const SearchLimits& limits,
+										 const std::function <void(const SearchResult&)>& onIteration)
+{
+	this->limits = limits;
+	rootPlayer = game.getCurrentTurn();
+	nodes = 0;
+	tableProbes = 0;
+	tableHits = 0;
+	publishedNodes = 0;
+	stopped = false;
+	start = std::chrono::steady_clock::now();
+
+	table.newSearch();
+
+	SearchResult result;
+	MoveList moves;
+	game.generateAllMoves(moves);
+
+	if(moves.empty())
+		return result;
+
+	//	Each helper thread gets a private copy of the game
+	size_t helperCount = limits.threads > 1 && moves.size() > 1 ? limits.threads - 1 : 0;
+	std::vector <Game> copies(helperCount, game);
+	std::vector <std::unique_ptr <Search>> helperSearches;
+	std::vector <std::thread> threads;
+
+	for(size_t i = 0; i < helperCount; i++)
+	{
+		helperSearches.emplace_back(new Search(table));
+		helperSearches.back()->mainThread = this;
+		helpers.push_back(helperSearches.back().get());
+	}
+
+	//	Every other helper skips a depth so that the helpers don't all do the same work
+	for(size_t i = 0; i < helperCount; i++)
+		threads.emplace_back(&Search::runHelper, helpers[i], std::ref(copies[i]), 1 + (i & 1));
+
+	//	If there's only one move there's nothing to think about
+	result.move = moves[0];
+	unsigned depthLimit = limits.depth == 0 || limits.depth > maxDepth ? maxDepth : limits.depth;
+
+	for(unsigned depth = 1; depth <= depthLimit && moves.size() > 1; depth++)
+	{
+		Move best;
+		int score = searchRoot(game, moves, depth, best);
+
+		//	Results of unfinished iterations can't be trusted
+		if(stopped)
+			break;
+
+		result.move = best;
+		result.score = score;
+		result.depth = depth;
+		result.nodes = totalNodes();
+		result.seconds = std::chrono::duration <double> (std::chrono::steady_clock::now() - start).count();
+
+		if(onIteration)
+			onIteration(result);
+
+		//	There's no point in searching deeper once a forced mate is found
+		if(score >= mateScore - static_cast <int> (depth) || score <= -mateScore + static_cast <int> (depth))
+			break;
+	}
+
+	//	The helpers only stop once the main thread is done
+	stopped = true;
+	for(auto& thread : threads)
+		thread.join();
+
+	result.threadNodes.push_back(nodes);
+	result.tableProbes = tableProbes;
+	result.tableHits = tableHits;
+
+	//	The helpers have stopped so their counters can be read
+	for(auto helper : helpers)
+	{
+		result.threadNodes.push_back(helper->nodes);
+		result.tableProbes += helper->tableProbes;
+		result.tableHits += helper->tableHits;
+	}
+
+	result.nodes = totalNodes();
+	helpers.clear();
+
+	result.seconds = std::chrono::duration <double> (std::chrono::steady_clock::now() - start).count();
+
+	return result;
+}
+
+void Chess::Search::runHelper(Game& game, unsigned firstDepth)
+{
+	rootPlayer = game.getCurrentTurn();
+	nodes = 0;
+	tableProbes = 0;
+	tableHits = 0;
+
+	MoveList moves;
+	game.generateAllMoves(moves);
+
+	for(unsigned depth = firstDepth; depth <= maxDepth && !stopped; depth++)
+	{
+		Move best;
+		searchRoot(game, moves, depth, best);
+	}
+
+	publishedNodes = nodes;
+}
+
+bool Chess::Search::probe(uint64_t hash, TranspositionTable::Entry& entry)
+{
+	bool found = table.probe(hash, entry);
+
+	tableProbes++;
+	tableHits += found;
+
+	return found;
+}
+
+uint64_t Chess::Search::totalNodes()
+{
+	uint64_t total = nodes;
+	for(auto helper : helpers)
+		total += helper->publishedNodes.load(std::memory_order_relaxed);
+
+	return total;
+}
+
+int Chess::Search::searchRoot(Game& game, MoveList& moves, unsigned depth, Move& best)
+{
+	int alpha = -mateScore - 1;
+	int beta = mateScore + 1;
+
+	//	Search the best move of the previous iteration first
+	TranspositionTable::Entry entry;
+	orderMoves(game, moves, probe(game.hash(), entry) ? entry.move : Move());
+
+	for(auto& move : moves)
+	{
+		if(capturesKing(game, move))
+		{
+			best = move;
+			return mateScore - 1;
+		}
+
+		Game::Undo undo;
+		game.makeMove(move, undo);
+
+		int score = sameSide(rootPlayer, game.getCurrentTurn()) ?
+					negamax(game, depth - 1, alpha, beta, 1) :
+					-negamax(game, depth - 1, -beta, -alpha, 1);
+
+		game.unmakeMove(undo);
+
+		if(stopped)
+			return alpha;
+
+		if(score > alpha)
+		{
+			alpha = score;
+			best = move;
+		}
+	}
+
+	TranspositionTable::Entry stored;
+	stored.move = best;
+	stored.score = alpha;
+	stored.depth = depth;
+	stored.bound = Bound::Exact;
+	table.store(game.hash(), stored);
+
+	return alpha;
+}
+
+int Chess::Search::negamax(Game& game, int depth, int alpha, int beta, unsigned ply)
+{
+	if(depth <= 0)
+		return quiescence(game, alpha, beta, ply);
+
+	if(shouldStop())
+		return 0;
+
+	nodes++;
+	size_t turn = game.getCurrentTurn();
+	uint64_t hash = game.hash();
+
+	Move hashMove;
+	TranspositionTable::Entry entry;
+
+	if(probe(hash, entry))
+	{
+		hashMove = entry.move;
+
+		//	Mate scores are stored relative to the position so make them relative to the root
+		int score = entry.score;
+		if(score > mateScore - static_cast <int> (maxDepth)) score -= ply;
+		else if(score < -mateScore + static_cast <int> (maxDepth)) score += ply;
+
+		if(entry.depth >= depth)
+		{
+			if(entry.bound == Bound::Exact) return score;
+			if(entry.bound == Bound::Lower && score >= beta) return score;
+			if(entry.bound == Bound::Upper && score <= alpha) return score;
+		}
+	}
+
+	MoveList moves;
+	game.generateAllMoves(moves);
+
+	//	Without legal moves the player is either checkmated or stalemated
+	if(moves.empty())
+		return game.inCheck(turn) ? -mateScore + static_cast <int> (ply) : 0;
+
+	orderMoves(game, moves, hashMove);
+
+	int originalAlpha = alpha;
+	int best = -mateScore - 1;
+	Move bestMove;
+
+	for(auto& move : moves)
+	{
+		//	Kings can only be captured when there are more than two players
+		if(capturesKing(game, move))
+			return mateScore - static_cast <int> (ply) - 1;
+
+		Game::Undo undo;
+		game.makeMove(move, undo);
+
+		//	Consecutive turns of the same side don't flip the score
+		int score = sameSide(turn, game.getCurrentTurn()) ?
+					negamax(game, depth - 1, alpha, beta, ply + 1) :
+					-negamax(game, depth - 1, -beta, -alpha, ply + 1);
+
+		game.unmakeMove(undo);
+
+		if(stopped)
+			return 0;
+
+		if(score > best)
+		{
+			best = score;
+			bestMove = move;
+		}
+
+		alpha = std::max(alpha, score);
+		if(alpha >= beta)
+			break;
+	}
+
+	TranspositionTable::Entry stored;
+	stored.move = bestMove;
+	stored.depth = depth;
+	stored.bound = best <= originalAlpha ? Bound::Upper : best >= beta ? Bound::Lower : Bound::Exact;
+
+	//	Store mate scores relative to this position
+	stored.score = best;
+	if(best > mateScore - static_cast <int> (maxDepth)) stored.score += ply;
+	else if(best < -mateScore + static_cast <int> (maxDepth)) stored.score -= ply;
+
+	table.store(hash, stored);
+	return best;
+}
+
+int Chess::Search::quiescence(Game& game, int alpha, int beta, unsigned ply)
+{
+	if(shouldStop())
+		return 0;
+
+	nodes++;
+
+	//	The player can choose to not capture anything
+	int standPat = evaluate(game);
+	if(standPat >= beta || ply >= maxDepth)
+		return standPat;
+
+	alpha = std::max(alpha, standPat);
+	size_t turn = game.getCurrentTurn();
+
+	MoveList moves;
+	game.generateAllMoves(moves, false);
+
+	//	Only captures and promotions are searched. Legality is checked after each move
+	size_t kept = 0;
+	for(size_t i = 0; i < moves.size(); i++)
+	{
+		if((moves[i].is(Move::Capture) || moves[i].is(Move::Promotion)) && !moves[i].underpromotion())
+			moves[kept++] = moves[i];
+	}
+
+	moves.resize(kept);
+	orderMoves(game, moves, Move());
+
+	for(auto& move : moves)
+	{
+		if(capturesKing(game, move))
+			return mateScore - static_cast <int> (ply) - 1;
+
+		Game::Undo undo;
+		game.makeMove(move, undo);
+
+		if(game.inCheck(turn))
+		{
+			game.unmakeMove(undo);
+			continue;
+		}
+
+		int score = sameSide(turn, game.getCurrentTurn()) ?
+					quiescence(game, alpha, beta, ply + 1) :
+					-quiescence(game, -beta, -alpha, ply + 1);
+
+		game.unmakeMove(undo);
+
+		if(stopped)
+			return 0;
+
+		alpha = std::max(alpha, score);
+		if(alpha >= beta)
+			break;
+	}
+
+	return alpha;
+}
+
+int Chess::Search::evaluate(Game& game)
+{
+	size_t turn = game.getCurrentTurn();
+
+	//	The network scores the position from the perspective of the root player
+	if(game.getNetwork())
+	{
+		int score = game.networkScore(rootPlayer);
+		return sameSide(turn, rootPlayer) ? score : -score;
+	}
+
+	//	Material of the side of the current player is compared against the other side
+	int score = 0;
+	for(size_t i = 0; i < game.getPlayerCount(); i++)
+		score += sameSide(i, turn) ? game.pieceScore(i) : -game.pieceScore(i);
+
+	return score;
+}
+
+void Chess::Search::orderMoves(Game& game, MoveList& list, const Move& first)
+{
+	int priority[MoveList::capacity];
+
+	for(size_t i = 0; i < list.size(); i++)
+	{
+		const Move& move = list[i];
+		priority[i] = 0;
+
+		if(move == first)
+			priority[i] = 1 << 20;
+
+		//	Capture the most valuable victim with the least valuable attacker
+		else if(move.is(Move::Capture))
+		{
+			Vec2s from = move.from();
+			Vec2s to = move.to();
+
+			priority[i] = 1 << 16;
+			priority[i] += MoveTables::pieceValues[static_cast <size_t> (game.at(to.x, to.y).piece)] * 8;
+			priority[i] -= MoveTables::pieceValues[static_cast <size_t> (game.at(from.x, from.y).piece)] / 100;
+		}
+
+		if(move.is(Move::Promotion))
+			priority[i] += MoveTables::pieceValues[static_cast <size_t> (move.promotion())] * 16;
+	}
+
+	//	Insertion sort is fast for short lists and it keeps the generation order for ties
+	for(size_t i = 1; i < list.size(); i++)
+	{
+		Move move = list[i];
+		int value = priority[i];
+		size_t j = i;
+
+		for(; j > 0 && priority[j - 1] < value; j--)
+		{
+			list[j] = list[j - 1];
+			priority[j] = priority[j - 1];
+		}
+
+		list[j] = move;
+		priority[j] = value;
+	}
+}
+
+bool Chess::Search::capturesKing(Game& game, const Move& move)
+{
+	Vec2s to = move.to();
+	return move.is(Move::Capture) && game.at(to.x, to.y).piece == PieceName::King;
+}
+
+bool Chess::Search::shouldStop()
+{
+	if(stopped.load(std::memory_order_relaxed))
+		return true;
+
+	//	Looking at the clock is slow so only do it every now and then
+	if((nodes & 1023) != 0)
+		return false;
+
+	publishedNodes.store(nodes, std::memory_order_relaxed);
+
+	//	Only the main thread looks at the limits
+	if(mainThread)
+	{
+		if(mainThread->stopped.load(std::memory_order_relaxed))
+			stopped = true;
+
+		return stopped;
+	}
+
+	if(limits.nodes > 0 && totalNodes() >= limits.nodes)
+		stopped = true;
+
+	if(limits.milliseconds > 0)
+	{
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		if(elapsed >= std::chrono::milliseconds(limits.milliseconds))
+			stopped = true;
+	}
+
+	return stopped;
+}
@@ -0,0 +1,115 @@
+#ifndef CHESS_SEARCH_HEADER
+#define CHESS_SEARCH_HEADER
+
+#include "TranspositionTable.hh"
+#include "Move.hh"
+
+#include <functional>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace Chess
+{
+
+class Game;
+
+//	Zero means that there's no limit
+struct SearchLimits
+{
+	unsigned depth = 0;
+	uint64_t nodes = 0;
+	unsigned milliseconds = 0;
+
+	//	How many threads search the position at the same time
+	unsigned threads = 1;
+};
+
+struct SearchResult
+{
+	Move move;
+	int score = 0;
+	unsigned depth = 0;
+
+	uint64_t nodes = 0;
+	double seconds = 0.0;
+
+	//	How many nodes each thread searched. The first one is the main thread
+	std::vector <uint64_t> threadNodes;
+
+	//	Transposition table probes of every thread and how many of them found an entry
+	uint64_t tableProbes = 0;
+	uint64_t tableHits = 0;
+
+	double nodesPerSecond() const { return seconds > 0.0 ? nodes / seconds : 0.0; }
+	double tableHitRate() const { return tableProbes > 0 ? static_cast <double> (tableHits) / tableProbes : 0.0; }
+};
+
+/*	Search finds the best move for the current player with iterative deepening
+ *	negamax and alpha-beta pruning. When there are more than two players, the
+ *	other players are assumed to work together against the current player.
+ *
+ *	With multiple threads the search is Lazy SMP. Every helper thread searches
+ *	the same position with a private copy of the game, and the only thing that
+ *	they share is the transposition table. The helpers start from different
+ *	depths so that they fill the table with results that the main thread needs */
+class Search
+{
+public:
+	static const int mateScore = 30000;
+	static const unsigned maxDepth = 64;
+
+	Search(TranspositionTable& table) : table(table) {}
+
+	/*	run() searches the given game until a limit is reached. The game is
+	 *	modified during the search but it's restored before run() returns.
+	 *	onIteration is called by the main thread after each completed depth */
+	SearchResult run(Game& game, const SearchLimits& limits,
+					 const std::function <void(const SearchResult&)>& onIteration = nullptr);
+
+	//	Can be called from another thread to stop the search early
+	void stop() { stopped = true; }
+
+private:
+	void runHelper(Game& game, unsigned firstDepth);
+	uint64_t totalNodes();
+
+	int searchRoot(Game& game, MoveList& moves, unsigned depth, Move& best);
+	int negamax(Game& game, int depth, int alpha, int beta, unsigned ply);
+	int quiescence(Game& game, int alpha, int beta, unsigned ply);
+
+	int evaluate(Game& game);
+	void orderMoves(Game& game, MoveList& list, const Move& first);
+	bool capturesKing(Game& game, const Move& move);
+	bool sameSide(size_t player1, size_t player2) { return (player1 == rootPlayer) == (player2 == rootPlayer); }
+	bool shouldStop();
+
+	//	Probes the table and counts the probe for this thread
+	bool probe(uint64_t hash, TranspositionTable::Entry& entry);
+
+	TranspositionTable& table;
+	SearchLimits limits;
+
+	size_t rootPlayer = 0;
+	uint64_t nodes = 0;
+
+	//	Each thread counts its own probes so that they don't share a cache line
+	uint64_t tableProbes = 0;
+	uint64_t tableHits = 0;
+	std::atomic <bool> stopped { false };
+
+	/*	Other threads can't read nodes so it's copied here every now and
+	 *	then. The main thread uses these to check the node limit */
+	std::atomic <uint64_t> publishedNodes { 0 };
+
+	//	Helpers stop when the main thread stops
+	Search* mainThread = nullptr;
+	std::vector <Search*> helpers;
+
+	std::chrono::steady_clock::time_point start;
+};
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef CHESS_SHAPE_HEADER
+#define CHESS_SHAPE_HEADER
+
+#include "../Vector2.hh"
+
+#include <cstddef>
+
+namespace Chess
+{
+
+/*	Shape tells the board size and the player count at compile time so that
+ *	loops over tiles and players can be unrolled. Zero means that the value is
+ *	only known at runtime, in which case the given runtime value is used */
+template <size_t Width, size_t Height, size_t Players>
+struct Shape
+{
+	static const bool dynamic = Width == 0 || Height == 0 || Players == 0;
+	static const bool bitBoards = Width == 8 && Height == 8 && Players == 2;
+
+	static size_t width(const Vec2s& size) { return Width ? Width : size.x; }
+	static size_t height(const Vec2s& size) { return Height ? Height : size.y; }
+	static size_t players(size_t count) { return Players ? Players : count; }
+};
+
+//	The layouts that have their own instantiations of the engine
+typedef Shape <0, 0, 0> DynamicShape;
+typedef Shape <8, 8, 2> StandardShape;
+typedef Shape <12, 8, 2> WideShape;
+typedef Shape <14, 14, 4> FourPlayerShape;
+
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include "TranspositionTable.hh"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+Chess::TranspositionTable::TranspositionTable(size_t megabytes, bool hugePages)
+{
+	resize(megabytes, hugePages);
+}
+
+Chess::TranspositionTable::~TranspositionTable()
+{
+	release();
+}
+
+void Chess::TranspositionTable::resize(size_t megabytes, bool hugePages)
+{
+	release();
+
+	//	Find the largest power of two bucket count that fits in the given size
+	size_t count = 1;
+	while(count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024)
+		count *= 2;
+
+	allocated = count * sizeof(Bucket);
+	mask = count - 1;
+
+#ifdef __linux__
+	//	Explicit huge pages need to be reserved by the system so this can fail
+	if(hugePages)
+	{
+		void* memory = mmap(nullptr, allocated, PROT_READ | PROT_WRITE,
+							MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+		if(memory != MAP_FAILED)
+		{
+			buckets = static_cast <Bucket*> (memory);
+			hugePageMapping = true;
+		}
+	}
+#endif
+
+	if(!buckets)
+	{
+		//	Aligning to 2MB lets transparent huge pages back the table
+		size_t alignment = allocated >= (1 << 21) ? (1 << 21) : alignof(Bucket);
+		buckets = static_cast <Bucket*> (std::aligned_alloc(alignment, allocated));
+
+		if(!buckets)
+			throw std::bad_alloc();
+
+#ifdef __linux__
+		if(hugePages)
+			madvise(buckets, allocated, MADV_HUGEPAGE);
+#endif
+	}
+
+	for(size_t i = 0; i < count; i++)
+		new (&buckets[i]) Bucket();
+}
+
+void Chess::TranspositionTable::release()
+{
+	if(!buckets)
+		return;
+
+#ifdef __linux__
+	if(hugePageMapping)
+		munmap(buckets, allocated);
+
+	else std::free(buckets);
+#else
+	std::free(buckets);
+#endif
+
+	buckets = nullptr;
+	hugePageMapping = false;
+}
+
+void Chess::TranspositionTable::clear()
+{
+	for(size_t i = 0; i <= mask; i++)
+	{
+		for(auto& slot : buckets[i].slots)
+		{
+			slot.key.store(0, std::memory_order_relaxed);
+			slot.data.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	generation = 0;
+}
+
+void Chess::TranspositionTable::newSearch()
+{
+	//	The generation is stored in 6 bits
+	generation = (generation + 1) & 63;
+}
+
+bool Chess::TranspositionTable::probe(uint64_t hash, Entry& entry)
+{
+	Bucket& bucket = buckets[hash & mask];
+
+	for(auto& slot : bucket.slots)
+	{
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+
+		//	If the key doesn't match, the slot has another position or it's being written
+		if((slot.key.load(std::memory_order_relaxed) ^ data) == hash && data != 0)
+		{
+			entry = unpack(data);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Chess::TranspositionTable::store(uint64_t hash, const Entry& entry)
+{
+	Bucket& bucket = buckets[hash & mask];
+	Slot* replace = nullptr;
+	int worst = 0;
+
+	for(auto& slot : bucket.slots)
+	{
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+
+		//	Always overwrite an entry of the same position
+		if((slot.key.load(std::memory_order_relaxed) ^ data) == hash || data == 0)
+		{
+			replace = &slot;
+			break;
+		}
+
+		/*	Otherwise replace the entry that has the least value. Shallow
+		 *	entries from older searches are the first to go */
+		Entry old = unpack(data);
+		int age = (generation - (data >> 58)) & 63;
+		int value = old.depth - age * 8;
+
+		if(!replace || value < worst)
+		{
+			replace = &slot;
+			worst = value;
+		}
+	}
+
+	uint64_t data = pack(entry, generation);
+	replace->key.store(hash ^ data, std::memory_order_relaxed);
+	replace->data.store(data, std::memory_order_relaxed);
+}
+
+uint64_t Chess::TranspositionTable::pack(const Entry& entry, uint8_t generation)
+{
+	//	Move 32 bits, score 16 bits, depth 8 bits, bound 2 bits and generation 6 bits
+	return	static_cast <uint64_t> (entry.move.raw()) |
+			static_cast <uint64_t> (static_cast <uint16_t> (entry.score)) << 32 |
+			static_cast <uint64_t> (entry.depth) << 48 |
+			static_cast <uint64_t> (entry.bound) << 56 |
+			static_cast <uint64_t> (generation) << 58;
+}
+
+Chess::TranspositionTable::Entry Chess::TranspositionTable::unpack(uint64_t data)
+{
+	Entry entry;
+	entry.move = Move::fromRaw(data & 0xFFFFFFFF);
+	entry.score = static_cast <int16_t> (data >> 32);
+	entry.depth = (data >> 48) & 0xFF;
+	entry.bound = static_cast <Bound> ((data >> 56) & 3);
+
+	return entry;
+}
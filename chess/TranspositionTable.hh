@@ -0,0 +1,88 @@
+#ifndef CHESS_TRANSPOSITION_TABLE_HEADER
+#define CHESS_TRANSPOSITION_TABLE_HEADER
+
+#include "Move.hh"
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+namespace Chess
+{
+
+enum class Bound : uint8_t
+{
+	None,
+	Exact,
+	Lower,
+	Upper
+};
+
+/*	TranspositionTable stores search results by position hash. It can be shared by
+ *	threads without locks. Each entry is 16 bytes where the first 8 bytes are
+ *	the hash XORed with the last 8 bytes. If another thread overwrites only half
+ *	of an entry, the hash doesn't match anymore and the entry is ignored */
+class TranspositionTable
+{
+public:
+	struct Entry
+	{
+		Move move;
+		int16_t score = 0;
+		uint8_t depth = 0;
+		Bound bound = Bound::None;
+	};
+
+	TranspositionTable(size_t megabytes = 16, bool hugePages = false);
+	~TranspositionTable();
+
+	TranspositionTable(const TranspositionTable&) = delete;
+	TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+	/*	resize() reallocates the table. The size is rounded down to a power of two.
+	 *	If hugePages is true, huge pages are used when the system supports them.
+	 *	This must not be called while other threads use the table */
+	void resize(size_t megabytes, bool hugePages = false);
+	void clear();
+
+	//	Should be called before each search so that older entries are replaced first
+	void newSearch();
+
+	/*	probe() doesn't count anything because counters that every thread
+	 *	updates would be slower than the table. Search counts its own probes */
+	bool probe(uint64_t hash, Entry& entry);
+	void store(uint64_t hash, const Entry& entry);
+
+	size_t getEntryCount() { return (mask + 1) * bucketSize; }
+	bool usesHugePages() { return hugePageMapping; }
+
+private:
+	struct Slot
+	{
+		std::atomic <uint64_t> key { 0 };
+		std::atomic <uint64_t> data { 0 };
+	};
+
+	//	Each bucket is a cache line of slots with the same index
+	static const size_t bucketSize = 4;
+	struct alignas(64) Bucket
+	{
+		Slot slots[bucketSize];
+	};
+
+	static uint64_t pack(const Entry& entry, uint8_t generation);
+	static Entry unpack(uint64_t data);
+
+	void release();
+
+	Bucket* buckets = nullptr;
+	size_t mask = 0;
+	size_t allocated = 0;
+	bool hugePageMapping = false;
+
+	uint8_t generation = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#include "Zobrist.hh"
+
+Chess::Zobrist::Zobrist()
+{
+	//	SplitMix64 is good enough for hash keys
+	uint64_t state = 0x9E3779B97F4A7C15ULL;
+	auto next = [&state]()
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	};
+
+	for(auto& player : pieces)
+	{
+		for(auto& piece : player)
+		{
+			for(auto& key : piece)
+				key = next();
+		}
+	}
+
+	for(auto& key : enPassants) key = next();
+	for(auto& key : turns) key = next();
+	for(auto& key : castlingRights) key = next();
+}
+
+const Chess::Zobrist& Chess::Zobrist::keys()
+{
+	static const Zobrist instance;
+	return instance;
+}
+
+uint64_t Chess::Zobrist::piece(const Tile& tile, const Vec2s& position)
+{
+	//	Empty tiles don't change the hash
+	if(tile.piece == PieceName::None)
+		return 0;
+
+	return keys().pieces[tile.playerID % maxPlayers][static_cast <size_t> (tile.piece)][(position.y << 4 | position.x) & 0xFF];
+}
+
+uint64_t Chess::Zobrist::enPassant(const Vec2s& position)
+{
+	return keys().enPassants[(position.y << 4 | position.x) & 0xFF];
+}
+
+uint64_t Chess::Zobrist::turn(size_t playerID)
+{
+	return keys().turns[playerID % maxPlayers];
+}
+
+uint64_t Chess::Zobrist::castling(uint32_t rights)
+{
+	uint64_t result = 0;
+	rights &= (1 << (maxPlayers * 3)) - 1;
+
+	for(; rights; rights &= rights - 1)
+		result ^= keys().castlingRights[__builtin_ctz(rights)];
+
+	return result;
+}
@@ -0,0 +1,39 @@
+#ifndef CHESS_ZOBRIST_HEADER
+#define CHESS_ZOBRIST_HEADER
+
+#include "../Vector2.hh"
+#include "Piece.hh"
+
+#include <cstdint>
+
+namespace Chess
+{
+
+/*	Zobrist contains the random keys that are XORed together to form the hash
+ *	of a position. The keys are generated from a fixed seed so that the same
+ *	position always has the same hash */
+class Zobrist
+{
+public:
+	static const size_t maxPlayers = 4;
+
+	static uint64_t piece(const Tile& tile, const Vec2s& position);
+	static uint64_t enPassant(const Vec2s& position);
+	static uint64_t turn(size_t playerID);
+
+	//	Returns the combined key of each set bit in the castling rights
+	static uint64_t castling(uint32_t rights);
+
+private:
+	Zobrist();
+	static const Zobrist& keys();
+
+	uint64_t pieces[maxPlayers][7][256];
+	uint64_t enPassants[256];
+	uint64_t turns[maxPlayers];
+	uint64_t castlingRights[maxPlayers * 3];
+};
+
+}
+
+#endif
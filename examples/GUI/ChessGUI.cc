@@ -113,13 +113,13 @@ void ChessGUI::onRender()
 
 	for(auto& cache : cachedMoves)
 	{
-		switch(cache.second)
+		switch(cache.type())
 		{
 			case Chess::MoveType::Capture: window(WindowID::Main).setColor(255, 0, 0); break;
 			case Chess::MoveType::Move: window(WindowID::Main).setColor(0, 255, 0); break;
 		}
 
-		Vec2 origin = tileSize * cache.first.as <float> ();
+		Vec2 origin = tileSize * cache.to().as <float> ();
 		window(WindowID::Main).drawBox(origin, tileSize, false, 1);
 		window(WindowID::Main).drawLine(origin, origin + tileSize);
 		window(WindowID::Main).drawLine(origin + Vec2(tileSize.x, 0.0f), origin + Vec2(0.0f, tileSize.y));
@@ -131,10 +131,7 @@ void ChessGUI::onRender()
 void ChessGUI::cacheMoves()
 {
 	cachedMoves.clear();
-	e.legalMoves(selected, [this](Vector2 <size_t> pos, Chess::MoveType type)
-	{
-		cachedMoves.push_back(std::make_pair(pos, type));
-	});
+	e.legalMoves(selected, cachedMoves);
 }
 
 void ChessGUI::onMouseClick(bool left, bool right)
@@ -171,7 +168,7 @@ void ChessGUI::onMouseClick(bool left, bool right)
 
 		for(auto& cache : cachedMoves)
 		{
-			if(cache.first == newSelection)
+			if(cache.to() == newSelection)
 			{
 				if(!e.move(selected, newSelection))
 					askPromotion = true;
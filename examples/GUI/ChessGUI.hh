@@ -4,9 +4,6 @@
 #include "Application.hh"
 #include "../../chess/Game.hh"
 
-#include <vector>
-#include <utility>
-
 enum class WindowID
 {
 	Main
@@ -27,7 +24,7 @@ private:
 	Chess::Game e;
 
 	void cacheMoves();
-	std::vector <std::pair <Vector2 <size_t>, Chess::MoveType>> cachedMoves;
+	Chess::MoveList cachedMoves;
 };
 
 #endif
@@ -0,0 +1,66 @@
+#include "Command.hh"
+
+static bool isSpace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/*	Each command has a different length and first letter, so together they're a
+ *	perfect hash. Commands that collide would be duplicate cases and not compile */
+static constexpr unsigned hash(std::string_view name)
+{
+	return name.empty() ? 0 : static_cast <unsigned> (name.size()) << 8 | static_cast <unsigned char> (name[0]);
+}
+
+std::string_view Tokens::word()
+{
+	while(offset < text.size() && isSpace(text[offset]))
+		offset++;
+
+	size_t start = offset;
+	while(offset < text.size() && !isSpace(text[offset]))
+		offset++;
+
+	return text.substr(start, offset - start);
+}
+
+bool Tokens::number(size_t& result)
+{
+	std::string_view digits = word();
+
+	//	Nothing sent to the server needs more digits than this
+	if(digits.empty() || digits.size() > 9)
+		return false;
+
+	size_t value = 0;
+	for(char c : digits)
+	{
+		if(c < '0' || c > '9')
+			return false;
+
+		value = value * 10 + c - '0';
+	}
+
+	result = value;
+	return true;
+}
+
+Command Tokens::command()
+{
+	std::string_view name = word();
+	auto is = [&name](std::string_view command) { return name == command; };
+
+	//	The hash only chooses the candidate so the whole name is still compared
+	switch(hash(name))
+	{
+		case hash("list"): return is("list") ? Command::List : Command::Invalid;
+		case hash("create"): return is("create") ? Command::Create : Command::Invalid;
+		case hash("join"): return is("join") ? Command::Join : Command::Invalid;
+		case hash("legal"): return is("legal") ? Command::Legal : Command::Invalid;
+		case hash("move"): return is("move") ? Command::Move : Command::Invalid;
+		case hash("promote"): return is("promote") ? Command::Promote : Command::Invalid;
+		case hash("sync"): return is("sync") ? Command::Sync : Command::Invalid;
+	}
+
+	return Command::Invalid;
+}
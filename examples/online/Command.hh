@@ -0,0 +1,44 @@
+#ifndef COMMAND_HEADER
+#define COMMAND_HEADER
+
+#include <string_view>
+#include <cstddef>
+
+enum class Command
+{
+	Invalid,
+
+	//	Commands for the server
+	List,
+	Create,
+	Join,
+
+	//	Commands for the room of the connection
+	Legal,
+	Move,
+	Promote,
+	Sync
+};
+
+/*	Tokens reads space separated words and numbers straight from a
+ *	message without copying it. The message has to outlive the tokens */
+class Tokens
+{
+public:
+	Tokens(std::string_view text) : text(text) {}
+
+	//	Returns an empty view when there are no words left
+	std::string_view word();
+
+	//	Returns false if the next word isn't a number
+	bool number(size_t& result);
+
+	//	Returns Command::Invalid for unknown words
+	Command command();
+
+private:
+	std::string_view text;
+	size_t offset = 0;
+};
+
+#endif
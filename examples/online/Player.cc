@@ -13,7 +13,7 @@ MoveResult Player::move(Vec2s to)
 	//	Is the given move found in the cache
 	for(auto& move : moves)
 	{
-		if(to == move.first)
+		if(to == move.to())
 		{
 			if(!game.move(movesFrom, to))
 				return MoveResult::Promotion;
@@ -25,32 +25,60 @@ MoveResult Player::move(Vec2s to)
 	return MoveResult::NoMove;
 }
 
-std::ostringstream Player::getLegalMoves(Vec2s from)
+void Player::findLegalMoves(Vec2s from)
 {
 	Vec2s boardSize = game.getBoardSize();
 	moves.clear();
 
 	std::cout << "Legal from " << from.x << ' ' << from.y << '\n';
 
-	std::ostringstream str;
-	str << "legal";
-
 	if(from.x >= boardSize.x || from.y >= boardSize.y)
-		return str;
+		return;
 
 	//	We want to prevent checks only on pieces owned by this player
 	bool protectKing = game.at(from.x, from.y).playerID == playerID;
 
 	movesFrom = from;
-	game.legalMoves(from, [this, &str](Vec2s pos, Chess::MoveType t)
+	game.legalMoves(from, moves, protectKing);
+}
+
+std::ostringstream Player::getLegalMoves()
+{
+	std::ostringstream str;
+	str << "legal";
+
+	for(auto& move : moves)
 	{
-		str << ' ' << pos.x << ' ' << pos.y << ' ' << static_cast <size_t> (t);
-		moves.push_back(std::make_pair(pos, t));
-	}, protectKing);
+		//	The promotion piece is chosen later so each target is only sent once
+		if(!move.underpromotion())
+			str << ' ' << move.to().x << ' ' << move.to().y << ' ' << static_cast <size_t> (move.type());
+	}
 
 	return str;
 }
 
+BinaryMessage Player::getLegalMovesBinary()
+{
+	BinaryMessage message(BinaryMessage::Legal);
+	size_t countAt = message.size();
+	size_t count = 0;
+
+	message.add(0);
+
+	for(auto& move : moves)
+	{
+		if(!move.underpromotion())
+		{
+			message.add(move.to());
+			message.add(static_cast <uint8_t> (move.type()));
+			count++;
+		}
+	}
+
+	message.set(countAt, count);
+	return message;
+}
+
 std::ostringstream Player::getView()
 {
 	std::ostringstream str;
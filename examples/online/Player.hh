@@ -2,11 +2,11 @@
 #define PLAYER_HEADER
 
 #include "../../chess/Game.hh"
+#include "Protocol.hh"
 
 #include <iostream>
 #include <sstream>
 #include <string>
-#include <vector>
 
 enum class MoveResult
 {
@@ -18,23 +18,30 @@ enum class MoveResult
 class Player
 {
 public:
-	Player(Chess::Game& game, const Chess::Player* player, size_t playerID)
-		: playerID(playerID), game(game), player(player)
+	Player(Chess::Game& game, const Chess::Player* player, size_t playerID, Protocol protocol)
+		: playerID(playerID), protocol(protocol), game(game), player(player)
 	{
 		std::cout << "Added player " << playerID << '\n';
 	}
 
 	MoveResult move(Vec2s to);
-	std::ostringstream getLegalMoves(Vec2s from);
 	std::ostringstream getView();
 
+	//	findLegalMoves() remembers the moves of the given piece for move()
+	void findLegalMoves(Vec2s from);
+
+	//	The moves that were found last in each protocol
+	std::ostringstream getLegalMoves();
+	BinaryMessage getLegalMovesBinary();
+
 	const size_t playerID;
+	const Protocol protocol;
 
 private:
 	Chess::Game& game;
 	const Chess::Player* player;
 
-	std::vector <std::pair <Vec2s, Chess::MoveType>> moves;
+	Chess::MoveList moves;
 	Vec2s movesFrom;
 };
 
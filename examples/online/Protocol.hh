@@ -0,0 +1,76 @@
+#ifndef PROTOCOL_HEADER
+#define PROTOCOL_HEADER
+
+#include "../../chess/Move.hh"
+#include "../../chess/MoveTables.hh"
+#include "../../Vector2.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+/*	Clients choose the protocol when they create or join a room by adding
+ *	"binary" after the room name. Otherwise the text protocol is used */
+enum class Protocol
+{
+	Text,
+	Binary
+};
+
+/*	BinaryMessage builds a message of the binary protocol in a fixed buffer.
+ *	Messages start with the protocol version and the message type:
+ *
+ *		Tiles	sequence number, width, height and a byte for each tile column
+ *				by column. The lowest 3 bits are the piece and the rest are the owner
+ *		Legal	move count and 2 bytes for each move: the target tile and 0
+ *				for a move or 1 for a capture
+ *		Check	count of threatened kings and the tile of each
+ *		Delta	sequence number, count of changed tiles and the position and
+ *				the new contents of each
+ *
+ *	Tiles are single bytes as y << 4 | x so boards can be at most 16x16.
+ *	Sequence numbers are 4 bytes with the lowest byte first */
+class BinaryMessage
+{
+public:
+	static const uint8_t version = 2;
+
+	enum Type : uint8_t
+	{
+		Tiles = 1,
+		Legal = 2,
+		Check = 3,
+		Delta = 4
+	};
+
+	BinaryMessage(Type type)
+	{
+		add(version);
+		add(type);
+	}
+
+	void add(uint8_t value) { buffer[length++] = value; }
+
+	void add32(uint32_t value)
+	{
+		for(size_t i = 0; i < 4; i++)
+			add(static_cast <uint8_t> (value >> i * 8));
+	}
+	void add(const Vec2s& tile) { add(static_cast <uint8_t> (tile.y << 4 | tile.x)); }
+
+	//	Tiles have the same layout as Chess::PackedTile
+	void add(const Chess::Tile& tile) { add(static_cast <uint8_t> (static_cast <unsigned> (tile.piece) | tile.playerID << 3)); }
+
+	//	Counts are often only known once the items have been added
+	void set(size_t index, uint8_t value) { buffer[index] = value; }
+
+	const uint8_t* data() const { return buffer; }
+	size_t size() const { return length; }
+
+private:
+	//	The longest message is either a list of moves or the whole board
+	uint8_t buffer[std::max(3 + 2 * Chess::MoveList::capacity, 8 + Chess::MoveTables::maxTiles)];
+	size_t length = 0;
+};
+
+#endif
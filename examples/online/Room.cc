@@ -1,121 +1,162 @@
 #include "Room.hh"
 
-void Room::handleMessage(Connection& conn, std::string& cmd, std::stringstream& args)
+void Room::receive(Connection conn, Message msg)
 {
-	if(cmd == "legal")
-	{
-		Vec2s legalFrom;
-		args >> legalFrom.x;
-		args >> legalFrom.y;
+	//	The tokens point to the payload that the message owns
+	Tokens args(msg->get_payload());
+	handleMessage(conn, args.command(), args);
+}
 
-		auto user = users.find(conn);
+void Room::handleMessage(Connection& conn, Command cmd, Tokens& args)
+{
+	auto found = users.find(conn);
+	if(found == users.end())
+		return;
 
-		//	Cache legal moves and store them to a stringstream
-		std::ostringstream ss = user->second.getLegalMoves(legalFrom);
-		server.send(conn, ss.str(), websocketpp::frame::opcode::text);
-	}
+	Player& user = found->second;
 
-	else if(cmd == "move")
+	switch(cmd)
 	{
-		Vec2s moveTo;
-		args >> moveTo.x;
-		args >> moveTo.y;
-
-		//	Can a move happen?
-		MoveResult result = users.find(conn)->second.move(moveTo);
-
-		//	Move happened
-		if(result == MoveResult::Moved)
+		case Command::Legal:
 		{
-			//	Inform the user that the given move happened
-			server.send(conn, "move", websocketpp::frame::opcode::text);
+			Vec2s legalFrom;
+			if(!args.number(legalFrom.x) || !args.number(legalFrom.y))
+				break;
 
-			std::ostringstream tileData = getTileData();
-			std::ostringstream checks;
+			//	Cache legal moves and send them in the protocol of the user
+			user.findLegalMoves(legalFrom);
 
-			checks << "check";
-			game.getChecks([&checks](Vec2s pos) { checks << ' ' << pos.x << ' ' << pos.y; });
+			if(user.protocol == Protocol::Binary)
+				send(conn, user.getLegalMovesBinary());
 
-			//	Send each user new tile and check data
-			for(auto& user : users)
+			else
 			{
-				server.send(user.first, tileData.str(), websocketpp::frame::opcode::text);
-				server.send(user.first, checks.str(), websocketpp::frame::opcode::text);
+				std::ostringstream ss = user.getLegalMoves();
+				send(conn, ss.str());
 			}
+
+			return;
 		}
 
-		//	Move happened and it led to a promotion
-		else if(result == MoveResult::Promotion)
+		case Command::Move:
 		{
-			waitForPromotion = true;
-			std::ostringstream promotion;
-			promotion << "promote " << game.getPromotion().x << ' ' << game.getPromotion().y;
-			server.send(conn, promotion.str(), websocketpp::frame::opcode::text);
-		}
-	}
+			Vec2s moveTo;
+			if(!args.number(moveTo.x) || !args.number(moveTo.y))
+				break;
 
-	else if(cmd == "promote")
-	{
-		Vec2s promotionAt = game.getPromotion();
+			//	Can a move happen?
+			MoveResult result = user.move(moveTo);
 
-		//	Is a promotion possible and is the correct user trying to promote
-		if(!waitForPromotion ||
-			users.find(conn)->second.playerID != game.at(promotionAt.x, promotionAt.y).playerID)
-		{
-			//	TODO Punish the user for trying to promote when it's not possible >:)
-			std::cout << "ILLEGAL PROMOTION\n";
+			//	Move happened
+			if(result == MoveResult::Moved)
+			{
+				//	Inform the user that the given move happened
+				send(conn, "move");
+				broadcastBoard();
+			}
+
+			//	Move happened and it led to a promotion
+			else if(result == MoveResult::Promotion)
+			{
+				waitForPromotion = true;
+				std::ostringstream promotion;
+				promotion << "promote " << game.getPromotion().x << ' ' << game.getPromotion().y;
+				send(conn, promotion.str());
+			}
+
+			return;
 		}
 
-		else
+		case Command::Promote:
 		{
+			Vec2s promotionAt = game.getPromotion();
+
+			//	Is a promotion possible and is the correct user trying to promote
+			if(!waitForPromotion ||
+				user.playerID != game.at(promotionAt.x, promotionAt.y).playerID)
+			{
+				//	TODO Punish the user for trying to promote when it's not possible >:)
+				std::cout << "ILLEGAL PROMOTION\n";
+				return;
+			}
+
+			//	Pawns can only become bishops, knights, rooks or queens
 			size_t newPiece;
-			args >> newPiece;
+			if(!args.number(newPiece) ||
+				newPiece < static_cast <size_t> (Chess::PieceName::Bishop) ||
+				newPiece > static_cast <size_t> (Chess::PieceName::Queen))
+				break;
+
 			std::cout << "PROMOTE TO " << newPiece << "\n";
 
 			//	Promote the piece to whatever the user said
 			game.promote(static_cast <Chess::PieceName> (newPiece));
 			waitForPromotion = false;
+			broadcastBoard();
 
-			std::ostringstream tileData = getTileData();
-			std::ostringstream checks;
+			return;
+		}
 
-			checks << "check";
-			game.getChecks([&checks](Vec2s pos) { checks << ' ' << pos.x << ' ' << pos.y; });
+		//	The client missed a broadcast so it needs the whole board
+		case Command::Sync:
+			sendBoard(conn, user.protocol);
+			return;
 
-			//	Send each user new tile and check data
-			for(auto& user : users)
-			{
-				server.send(user.first, tileData.str(), websocketpp::frame::opcode::text);
-				server.send(user.first, checks.str(), websocketpp::frame::opcode::text);
-			}
-		}
+		default:
+			break;
 	}
 
-	else server.send(conn, "invalid", websocketpp::frame::opcode::text);
+	//	Unknown commands and commands with malformed arguments end up here
+	send(conn, "invalid");
+}
+
+void Room::removeConnection(Connection& conn)
+{
+	auto user = users.find(conn);
+	if(user == users.end())
+		return;
+
+	//	The pieces of a player that left stay on the board for whoever takes the seat
+	if(user->second.playerID < maxPlayers)
+		seated--;
+
+	users.erase(user);
 }
 
-bool Room::connectionHere(Connection& conn)
+bool Room::seatTaken(size_t playerID)
 {
-	return users.find(conn) != users.end();
+	for(auto& user : users)
+	{
+		if(user.second.playerID == playerID)
+			return true;
+	}
+
+	return false;
 }
 
-void Room::addConnection(Connection& conn)
+void Room::addConnection(Connection& conn, Protocol protocol)
 {
 	std::ostringstream str;
 	Vec2s boardSize = game.getBoardSize();
 
 	//	Tell whoever connected how large the board is
 	str << "size " << boardSize.x << ' ' << boardSize.y;
-	server.send(conn, str.str(), websocketpp::frame::opcode::text);
+	send(conn, str.str());
+
+	/*	Take the first seat that nobody is playing in. If every seat is
+	 *	taken, the ID is maxPlayers which doesn't belong to any player */
+	size_t id = 0;
+	while(id < game.getPlayerCount() && seatTaken(id))
+		id++;
 
 	//	Tell the player their ID
 	str = std::ostringstream(std::string());
 	str << "id ";
-	str << users.size();
-	server.send(conn, str.str(), websocketpp::frame::opcode::text);
+	str << id;
+	send(conn, str.str());
 
 	//	Can new players be added?
-	if(users.size() < maxPlayers)
+	if(id < maxPlayers)
 	{
 		//	Find the middle point of the board
 		size_t centerLeft = boardSize.x / 2 - 1;
@@ -130,18 +171,23 @@ void Room::addConnection(Connection& conn)
 			Vec2s(boardSize.x - 1, centerLeft)
 		};
 
-		//	Add a new player
-		const Chess::Player& p = game.addPlayer(positions[users.size()], middle, false);
-		Player& newUser = users.emplace(conn, Player(game, &p, users.size())).first->second;
+		//	Add a new player unless the seat of someone who left is free
+		if(id == game.getPlayerCount())
+		{
+			game.addPlayer(positions[id], middle, false);
+
+			//	Inform the other users about the new pieces on the board
+			broadcastBoard();
+		}
+
+		const Chess::Player& p = game.getPlayer(id);
+		Player& newUser = users.emplace(conn, Player(game, &p, id, protocol)).first->second;
+		seated++;
 
 		//	Tell the player who they should look at the board
 		str = newUser.getView();
-		server.send(conn, str.str(), websocketpp::frame::opcode::text);
-
-		//	Inform each player about the new pieces on the board
-		str = getTileData();
-		for(auto& user : users)
-			server.send(user.first, str.str(), websocketpp::frame::opcode::text);
+		send(conn, str.str());
+		sendBoard(conn, protocol);
 
 		//	TODO Wait for all players to connect before starting the game
 	}
@@ -149,16 +195,9 @@ void Room::addConnection(Connection& conn)
 	//	New players couldn't be added so add the user as a spectator
 	else
 	{
-		//	Send data about the tiles to new spectators
-		users.emplace(conn, Player(game, nullptr, users.size()));
-		str = getTileData();
-		server.send(conn, str.str(), websocketpp::frame::opcode::text);
-
-		//	Send check information to new spectators
-		std::ostringstream checks;
-		checks << "check";
-		game.getChecks([&checks](Vec2s pos) { checks << ' ' << pos.x << ' ' << pos.y; });
-		server.send(conn, checks.str(), websocketpp::frame::opcode::text);
+		//	Send data about the tiles and checks to new spectators
+		users.emplace(conn, Player(game, nullptr, id, protocol));
+		sendBoard(conn, protocol);
 	}
 }
 
@@ -166,7 +205,7 @@ std::ostringstream Room::getStatus()
 {
 	//	Return user count that doesn't include spectators and maximum player count
 	std::ostringstream ss;
-	ss << (users.size() > maxPlayers ? maxPlayers : users.size()) << ' ' << maxPlayers;
+	ss << seated.load() << ' ' << maxPlayers;
 
 	return ss;
 }
@@ -175,13 +214,191 @@ std::ostringstream Room::getTileData()
 {
 	Vec2s boardSize = game.getBoardSize();
 	std::ostringstream str;
-	str << "tile";
+	str << "tile " << sequence;
 
 	for(size_t x = 0; x < boardSize.x; x++)
 	{
 		for(size_t y = 0; y < boardSize.y; y++)
-			str << ' ' << static_cast <size_t> (game.at(x, y).piece) << ' ' << game.at(x, y).playerID;
+		{
+			Chess::Tile tile = game.at(x, y);
+			str << ' ' << static_cast <size_t> (tile.piece) << ' ' << tile.playerID;
+		}
+	}
+
+	return str;
+}
+
+std::ostringstream Room::getCheckData()
+{
+	std::ostringstream str;
+	str << "check";
+
+	game.getChecks([&str](Vec2s pos) { str << ' ' << pos.x << ' ' << pos.y; });
+	return str;
+}
+
+std::ostringstream Room::getDeltaData()
+{
+	std::ostringstream str;
+	str << "delta " << sequence;
+
+	for(auto& pos : changedTiles)
+	{
+		Chess::Tile tile = game.at(pos.x, pos.y);
+		str << ' ' << pos.x << ' ' << pos.y << ' ' << static_cast <size_t> (tile.piece) << ' ' << tile.playerID;
 	}
 
 	return str;
 }
+
+BinaryMessage Room::getTileDataBinary()
+{
+	Vec2s boardSize = game.getBoardSize();
+	BinaryMessage message(BinaryMessage::Tiles);
+
+	message.add32(sequence);
+	message.add(boardSize.x);
+	message.add(boardSize.y);
+
+	for(size_t x = 0; x < boardSize.x; x++)
+	{
+		for(size_t y = 0; y < boardSize.y; y++)
+			message.add(game.at(x, y));
+	}
+
+	return message;
+}
+
+BinaryMessage Room::getCheckDataBinary()
+{
+	BinaryMessage message(BinaryMessage::Check);
+	size_t countAt = message.size();
+	size_t count = 0;
+
+	message.add(0);
+	game.getChecks([&](Vec2s pos) { message.add(pos); count++; });
+	message.set(countAt, count);
+
+	return message;
+}
+
+BinaryMessage Room::getDeltaDataBinary()
+{
+	BinaryMessage message(BinaryMessage::Delta);
+
+	message.add32(sequence);
+	message.add(changedTiles.size());
+
+	for(auto& pos : changedTiles)
+	{
+		message.add(pos);
+		message.add(game.at(pos.x, pos.y));
+	}
+
+	return message;
+}
+
+void Room::findChangedTiles()
+{
+	Vec2s boardSize = game.getBoardSize();
+	changedTiles.clear();
+
+	//	Nothing has been sent yet so every tile is new
+	if(sentBoard.size() != boardSize.x * boardSize.y)
+		sentBoard.assign(boardSize.x * boardSize.y, Chess::PackedTile());
+
+	for(size_t x = 0; x < boardSize.x; x++)
+	{
+		for(size_t y = 0; y < boardSize.y; y++)
+		{
+			Chess::Tile tile = game.at(x, y);
+			Chess::PackedTile& sent = sentBoard[x * boardSize.y + y];
+
+			if(sent.piece() != tile.piece || sent.playerID() != tile.playerID)
+			{
+				changedTiles.push_back(Vec2s(x, y));
+				sent = tile;
+			}
+		}
+	}
+}
+
+void Room::broadcastBoard()
+{
+	findChangedTiles();
+	if(changedTiles.empty())
+		return;
+
+	sequence++;
+
+	/*	Moves only change a few tiles. When more than half of the board
+	 *	changes, like when a player is added, the whole board is smaller */
+	Vec2s boardSize = game.getBoardSize();
+	bool wholeBoard = changedTiles.size() * 2 > boardSize.x * boardSize.y;
+
+	//	Each message is only built if some user needs it
+	std::string tileText;
+	std::string checkText;
+	bool textReady = false;
+
+	BinaryMessage tiles(BinaryMessage::Tiles);
+	BinaryMessage checks(BinaryMessage::Check);
+	bool binaryReady = false;
+
+	for(auto& user : users)
+	{
+		if(user.second.protocol == Protocol::Binary)
+		{
+			if(!binaryReady)
+			{
+				tiles = wholeBoard ? getTileDataBinary() : getDeltaDataBinary();
+				checks = getCheckDataBinary();
+				binaryReady = true;
+			}
+
+			send(user.first, tiles);
+			send(user.first, checks);
+		}
+
+		else
+		{
+			if(!textReady)
+			{
+				tileText = wholeBoard ? getTileData().str() : getDeltaData().str();
+				checkText = getCheckData().str();
+				textReady = true;
+			}
+
+			send(user.first, tileText);
+			send(user.first, checkText);
+		}
+	}
+}
+
+void Room::sendBoard(Connection conn, Protocol protocol)
+{
+	//	The whole board has the sequence number of the latest broadcast
+	if(protocol == Protocol::Binary)
+	{
+		send(conn, getTileDataBinary());
+		send(conn, getCheckDataBinary());
+	}
+
+	else
+	{
+		send(conn, getTileData().str());
+		send(conn, getCheckData().str());
+	}
+}
+
+void Room::send(Connection conn, const std::string& text)
+{
+	websocketpp::lib::error_code error;
+	server.send(conn, text, websocketpp::frame::opcode::text, error);
+}
+
+void Room::send(Connection conn, const BinaryMessage& message)
+{
+	websocketpp::lib::error_code error;
+	server.send(conn, message.data(), message.size(), websocketpp::frame::opcode::binary, error);
+}
@@ -2,12 +2,17 @@
 #define ROOM_HEADER
 
 #include "../../chess/Game.hh"
+#include "Command.hh"
 #include "Player.hh"
 
 #include <websocketpp/server.hpp>
 #include <websocketpp/config/asio_no_tls.hpp>
 
 #include <sstream>
+#include <utility>
+#include <exception>
+#include <atomic>
+#include <vector>
 #include <map>
 
 typedef websocketpp::server<websocketpp::config::asio> Websocket;
@@ -17,25 +22,82 @@ typedef Websocket::message_ptr Message;
 class Room
 {
 public:
-	Room(Websocket& server) : server(server), game(12, 8)
+	Room(Websocket& server) : server(server), strand(server.get_io_service()), game(12, 8)
 	{
 	}
 
-	void handleMessage(Connection& conn, std::string& cmd, std::stringstream& args);
+	/*	The functions of a room that use the game or the users must only be
+	 *	called by handlers given to post(). They run one at a time in the
+	 *	order they were posted, while other rooms run on other threads */
+	template <typename Handler>
+	void post(Handler&& handler)
+	{
+		strand.post([handler = std::forward <Handler> (handler)]() mutable
+		{
+			//	An exception that reaches the thread pool would stop the whole server
+			try
+			{
+				handler();
+			}
+
+			catch (std::exception const & e)
+			{
+				std::cout << "Room failed because: "
+						  << "(" << e.what() << ")" << std::endl;
+			}
+		});
+	}
 
-	bool connectionHere(Connection& conn);
-	void addConnection(Connection& conn);
+	//	receive() reads the command of the message and handles it
+	void receive(Connection conn, Message msg);
 
+	void addConnection(Connection& conn, Protocol protocol);
+	void removeConnection(Connection& conn);
+
+	//	getStatus() can be called from any thread
 	std::ostringstream getStatus();
 
 private:
+	void handleMessage(Connection& conn, Command cmd, Tokens& args);
+
 	std::ostringstream getTileData();
+	std::ostringstream getCheckData();
+	std::ostringstream getDeltaData();
+	BinaryMessage getTileDataBinary();
+	BinaryMessage getCheckDataBinary();
+	BinaryMessage getDeltaDataBinary();
+
+	/*	Sends the tiles that changed since the last broadcast and the checks
+	 *	to every user in their own protocol. Each broadcast has the next
+	 *	sequence number so that clients can ask for the whole board with
+	 *	"sync" if they miss one */
+	void broadcastBoard();
+	void sendBoard(Connection conn, Protocol protocol);
+
+	//	Finds the tiles that differ from sentBoard and updates it
+	void findChangedTiles();
+
+	/*	Connections can close before the messages of the room reach them.
+	 *	Messages to closed connections are dropped instead of throwing */
+	void send(Connection conn, const std::string& text);
+	void send(Connection conn, const BinaryMessage& message);
+
+	//	Is there a user playing as the given player
+	bool seatTaken(size_t playerID);
+
 	Websocket& server;
+	websocketpp::lib::asio::io_service::strand strand;
 	Chess::Game game;
 
-	size_t maxPlayers = 2;
+	const size_t maxPlayers = 2;
+	std::atomic <size_t> seated { 0 };
 	bool waitForPromotion = false;
 
+	//	The board as of the last broadcast and the tiles changed by the latest one
+	std::vector <Chess::PackedTile> sentBoard;
+	std::vector <Vec2s> changedTiles;
+	uint32_t sequence = 0;
+
     std::map <Connection, Player, std::owner_less <Connection>> users;
 };
 
@@ -1,6 +1,8 @@
 #include "Server.hh"
 
 #include <algorithm>
+#include <thread>
+#include <vector>
 
 Server::Server(OptionParser& opt)
 {
@@ -14,103 +16,200 @@ Server::Server(OptionParser& opt)
 
 		try
 		{
-			std::stringstream received(msg->get_payload());
+			handleMessage(conn, msg);
+		}
 
-			std::string cmd;
-			received >> cmd;
+		catch (websocketpp::exception const & e)
+		{
+			std::cout << "Echo failed because: "
+					  << "(" << e.what() << ")" << std::endl;
+		}
+	});
 
-			//	If the connection is in a room, forward the message to that room
-			Room* room = findRoom(conn);
-			if(room) room->handleMessage(conn, cmd, received);
+	//	Connections that close leave their room
+	server.set_close_handler([this](Connection conn)
+	{
+		leave(conn);
+	});
 
-			else if(cmd == "list")
-			{
-				std::ostringstream roomData;
-				roomData << "list";
+	unsigned port = 9002;
+	auto portOpt = opt.describe("port", 'p', "The port to listen on", true);
 
-				//	Get the name and player info of each room
-				for(auto& room : rooms)
-					roomData << ' ' << room.first << ' ' << room.second.getStatus().str();
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	auto threadsOpt = opt.describe("threads", 't', "How many threads handle messages", true);
 
-				server.send(conn, roomData.str(), websocketpp::frame::opcode::text);
-			}
+	//	Stop if invalid options are found
+	if(opt.undescribed())
+		return;
 
-			else if(cmd == "create")
-			{
-				std::string roomName;
-				received >> roomName;
+	//	If they exist, use the values given by the user
+	opt.find(portOpt, port);
+	opt.find(threadsOpt, threads);
 
-				//	If the name is empty, ignore the message
-				if(roomName.empty())
-					return;
+	server.set_reuse_addr(true);
+	server.listen(port);
+	server.start_accept();
 
-				//	If the room already exists, inform the user
-				if(rooms.find(roomName) != rooms.end())
-				{
-					server.send(conn, "room-exists", websocketpp::frame::opcode::text);
-					return;
-				}
+	//	Every thread runs the same asio loop. This thread is one of them
+	std::vector <std::thread> pool;
+	for(unsigned i = 1; i < threads; i++)
+		pool.emplace_back([this]() { server.run(); });
 
-				server.send(conn, "create", websocketpp::frame::opcode::text);
+	server.run();
 
-				//	Add a new room and give this connection to it
-				auto room = rooms.emplace(roomName, Room(server));
-				room.first->second.addConnection(conn);
-			}
+	for(auto& thread : pool)
+		thread.join();
+}
+
+void Server::handleMessage(Connection conn, Message msg)
+{
+	std::shared_ptr <Room> joinedRoom;
+
+	{
+		std::shared_lock <std::shared_mutex> lock(roomLock);
+		auto joined = connectionRooms.find(key(conn));
+
+		if(joined != connectionRooms.end())
+			joinedRoom = joined->second->second.room;
+	}
 
-			else if(cmd == "join")
+	//	If the connection is in a room, forward the message to that room
+	if(joinedRoom)
+	{
+		joinedRoom->post([joinedRoom, conn, msg]() { joinedRoom->receive(conn, msg); });
+		return;
+	}
+
+	Tokens received(msg->get_payload());
+
+	switch(received.command())
+	{
+		case Command::List:
+		{
+			std::ostringstream roomData;
+			roomData << "list";
+
+			//	Get the name and player info of each room
 			{
-				std::string roomName;
-				received >> roomName;
+				std::shared_lock <std::shared_mutex> lock(roomLock);
+				for(auto& room : rooms)
+					roomData << ' ' << room.first << ' ' << room.second.room->getStatus().str();
+			}
 
-				auto it = rooms.find(roomName);
+			send(conn, roomData.str());
+			return;
+		}
+
+		case Command::Create:
+		{
+			std::string_view roomName = received.word();
 
-				//	Does the room exist?
-				if(it == rooms.end())
-				{
-					server.send(conn, "invalid-room", websocketpp::frame::opcode::text);
-					return;
-				}
+			//	If the name is empty, ignore the message
+			if(roomName.empty())
+				return;
 
-				server.send(conn, "join", websocketpp::frame::opcode::text);
+			Protocol protocol = readProtocol(received);
+			std::unique_lock <std::shared_mutex> lock(roomLock);
 
-				//	Add the connection to the given room
-				it->second.addConnection(conn);
+			//	If the room already exists, inform the user
+			auto room = rooms.try_emplace(std::string(roomName));
+			if(!room.second)
+			{
+				lock.unlock();
+				send(conn, "room-exists");
+				return;
 			}
 
-			else server.send(conn, "invalid", websocketpp::frame::opcode::text);
+			//	Add a new room and give this connection to it
+			room.first->second.room = std::make_shared <Room> (server);
+			std::shared_ptr <Room> joined = join(conn, *room.first);
+			lock.unlock();
+
+			send(conn, "create");
+			enter(conn, joined, protocol);
+			return;
 		}
 
-		catch (websocketpp::exception const & e)
+		case Command::Join:
 		{
-			std::cout << "Echo failed because: "
-					  << "(" << e.what() << ")" << std::endl;
+			std::string roomName(received.word());
+
+			Protocol protocol = readProtocol(received);
+			std::unique_lock <std::shared_mutex> lock(roomLock);
+
+			auto it = rooms.find(roomName);
+
+			//	Does the room exist?
+			if(it == rooms.end())
+			{
+				lock.unlock();
+				send(conn, "invalid-room");
+				return;
+			}
+
+			//	Add the connection to the given room
+			std::shared_ptr <Room> joined = join(conn, *it);
+			lock.unlock();
+
+			send(conn, "join");
+			enter(conn, joined, protocol);
+			return;
 		}
-	});
 
-	unsigned port = 9002;
-	auto portOpt = opt.describe("port", 'p', "The port to listen on", true);
+		default:
+			send(conn, "invalid");
+			return;
+	}
+}
 
-	//	Stop if invalid options are found
-	if(opt.undescribed())
-		return;
+std::shared_ptr <Room> Server::join(Connection conn, RoomMap::value_type& room)
+{
+	//	The caller holds the exclusive lock
+	connectionRooms[key(conn)] = &room;
+	room.second.connections++;
 
-	//	If it exists, use the port given by the user
-	opt.find(portOpt, port);
+	return room.second.room;
+}
 
-	server.set_reuse_addr(true);
-	server.listen(port);
-	server.start_accept();
-	server.run();
+void Server::enter(Connection conn, std::shared_ptr <Room> room, Protocol protocol)
+{
+	/*	This is posted after the reply to "create" or "join" has been sent
+	 *	so that the reply reaches the client before the messages of the room */
+	room->post([room, conn, protocol]() mutable { room->addConnection(conn, protocol); });
 }
 
-Room* Server::findRoom(Connection& conn)
+void Server::leave(Connection conn)
 {
-	for(auto& room : rooms)
+	std::shared_ptr <Room> room;
+
 	{
-		if(room.second.connectionHere(conn))
-			return &room.second;
+		std::unique_lock <std::shared_mutex> lock(roomLock);
+		auto joined = connectionRooms.find(key(conn));
+
+		if(joined == connectionRooms.end())
+			return;
+
+		RoomMap::value_type* entry = joined->second;
+		connectionRooms.erase(joined);
+		room = entry->second.room;
+
+		//	Empty rooms are removed so that their names can be used again
+		if(--entry->second.connections == 0)
+			rooms.erase(entry->first);
 	}
 
-	return nullptr;
+	room->post([room, conn]() mutable { room->removeConnection(conn); });
+}
+
+Protocol Server::readProtocol(Tokens& args)
+{
+	//	Clients that don't ask for a protocol use the text protocol
+	return args.word() == "binary" ? Protocol::Binary : Protocol::Text;
+}
+
+void Server::send(Connection conn, const std::string& text)
+{
+	//	Messages to connections that have already closed are dropped
+	websocketpp::lib::error_code error;
+	server.send(conn, text, websocketpp::frame::opcode::text, error);
 }
@@ -5,7 +5,10 @@
 #include "optionparser/OptionParser.hh"
 
 #include <unordered_map>
+#include <shared_mutex>
+#include <memory>
 #include <string>
+#include <string_view>
 
 class Server
 {
@@ -13,9 +16,39 @@ public:
 	Server(OptionParser& opt);
 
 private:
-	Room* findRoom(Connection& conn);
+	struct RoomEntry
+	{
+		/*	Messages that are being handled keep the room alive
+		 *	after it's removed from the map */
+		std::shared_ptr <Room> room;
+
+		//	How many connections are in the room
+		size_t connections = 0;
+	};
+
+	typedef std::unordered_map <std::string, RoomEntry> RoomMap;
+
+	void handleMessage(Connection conn, Message msg);
+	//	join() adds the connection to the index and enter() adds it to the room
+	std::shared_ptr <Room> join(Connection conn, RoomMap::value_type& room);
+	void enter(Connection conn, std::shared_ptr <Room> room, Protocol protocol);
+	void leave(Connection conn);
+	static Protocol readProtocol(Tokens& args);
+	void send(Connection conn, const std::string& text);
+
+	/*	Connections are identified by the address of their connection object.
+	 *	It stays the same until the connection is closed */
+	static const void* key(Connection conn) { return conn.lock().get(); }
+
+	/*	Messages are handled by several threads, so rooms and connectionRooms
+	 *	are read with a shared lock and changed with an exclusive lock */
+	std::shared_mutex roomLock;
+	RoomMap rooms;
+
+	/*	Which room each connection is in. Elements of an unordered_map
+	 *	don't move when it grows so pointing to them is safe */
+	std::unordered_map <const void*, RoomMap::value_type*> connectionRooms;
 
-	std::unordered_map <std::string, Room> rooms;
 	Websocket server;
 };
 
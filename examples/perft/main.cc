@@ -0,0 +1,273 @@
+#include "../../chess/Game.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <string>
+
+struct SuiteEntry
+{
+	const char* name;
+	const char* fen;
+	unsigned depth;
+	uint64_t nodes;
+};
+
+/*	Well known perft positions and regression tests. The depths are
+ *	chosen so that each position takes at most a few seconds */
+static const SuiteEntry suite[]
+{
+	{ "Initial", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609 },
+	{ "Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603 },
+	{ "Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624 },
+	{ "Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333 },
+	{ "Position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 4, 422333 },
+	{ "Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487 },
+	{ "Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594 },
+	{ "En passant pin", "8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1", 1, 6 },
+	{ "Castling through check", "r3k2r/8/8/8/8/8/8/2R1K2R b KQkq - 0 1", 1, 25 },
+	{ "Promotion", "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", 4, 182838 },
+
+	//	Layouts that use the attack maps instead of bitboards
+	{ "12x8 start", "@12x8 +yc1j1,-yc8j8 2R1N1B1K1Q1B1N1R12/2P1P1P1P1P1P1P1P12/12/12/12/12/2P0P0P0P0P0P0P0P02/2R0N0B0K0Q0B0N0R02 0 kq,kq -", 4, 605906 },
+	{ "10x10 3-player start", "@10x10 +yb1i1,-yb10i10,+xa2a9 1R1N1B1K1Q1B1N1R11/R2P2P1P1P1P1P1P1P11/N2P28/B2P28/Q2P28/K2P28/B2P28/N2P28/R2P2P0P0P0P0P0P0P01/1R0N0B0K0Q0B0N0R01 0 kq,kq,kq -", 4, 320891 },
+	{ "14x14 4-player start", "@14x14 +yd1k1,-yd14k14,+xa4a11,-xn4n11 3R1N1B1K1Q1B1N1R13/3P1P1P1P1P1P1P1P13/14/R2P210P3R3/N2P210P3N3/B2P210P3B3/Q2P210P3Q3/K2P210P3K3/B2P210P3B3/N2P210P3N3/R2P210P3R3/14/3P0P0P0P0P0P0P0P03/3R0N0B0K0Q0B0N0R03 0 kq,kq,kq,kq -", 4, 605274 },
+
+	//	More moves than the move lists used to fit
+	{ "14 queens on 16x16", "@16x16 +ya1p1,-ya16p16 K015/2K113/4Q011/1Q014/12Q03/8Q07/13Q02/11Q04/14Q01/5Q010/15Q0/6Q09/3Q012/10Q05/7Q08/9Q06 0 -,- -", 3, 21671 }
+};
+
+//	Set when a move list was too small and the count is incomplete
+static bool overflowed = false;
+
+static uint64_t perft(Chess::Game& game, unsigned depth)
+{
+	//	There's no need to make the moves on the last level
+	if(depth <= 1)
+		return depth == 1 ? game.countLegalMoves() : 1;
+
+	Chess::MoveList list;
+	game.generateAllMoves(list);
+	overflowed = overflowed || list.overflowed();
+
+	uint64_t nodes = 0;
+	for(auto& move : list)
+	{
+		Chess::Game::Undo undo;
+		game.makeMove(move, undo);
+		nodes += perft(game, depth - 1);
+		game.unmakeMove(undo);
+	}
+
+	return nodes;
+}
+
+static void printMove(const Chess::Move& move)
+{
+	const char promotions[] = " pbnrqk";
+
+	Vec2s from = move.from();
+	Vec2s to = move.to();
+
+	printf("%c%zu%c%zu", static_cast <char> ('a' + from.x), from.y + 1, static_cast <char> ('a' + to.x), to.y + 1);
+
+	if(move.is(Chess::Move::Promotion))
+		printf("%c", promotions[static_cast <size_t> (move.promotion())]);
+}
+
+static uint64_t run(Chess::Game& game, unsigned depth, bool divide, double& seconds)
+{
+	auto start = std::chrono::steady_clock::now();
+	uint64_t nodes = 0;
+
+	if(divide && depth > 0)
+	{
+		Chess::MoveList list;
+		game.generateAllMoves(list);
+		overflowed = overflowed || list.overflowed();
+
+		//	Show how many nodes there are under each root move
+		for(auto& move : list)
+		{
+			Chess::Game::Undo undo;
+			game.makeMove(move, undo);
+			uint64_t count = perft(game, depth - 1);
+			game.unmakeMove(undo);
+
+			printMove(move);
+			printf(": %lu\n", count);
+			nodes += count;
+		}
+	}
+
+	else nodes = perft(game, depth);
+
+	seconds = std::chrono::duration <double> (std::chrono::steady_clock::now() - start).count();
+	return nodes;
+}
+
+/*	Players whose pieces don't fit on the board used to be written past its
+ *	edges. Adding them should fail without changing the position */
+static bool checkSmallBoards()
+{
+	bool passed = true;
+	const Vec2s sizes[] { Vec2s(2, 2), Vec2s(4, 4), Vec2s(7, 8) };
+
+	for(auto& size : sizes)
+	{
+		Chess::Game game(size.x, size.y);
+		std::string before = game.toFEN();
+
+		size_t centerLeft = size.x / 2 - 1;
+		bool ok =	!game.addPlayer(Vec2s(centerLeft, 0), Vec2s(centerLeft, size.y / 2), false) &&
+					game.getPlayerCount() == 0 && game.toFEN() == before;
+
+		passed = passed && ok;
+		printf("%-24s %zux%zu rejected %s\n", "Player off the board", size.x, size.y, ok ? "ok" : "FAIL");
+	}
+
+	return passed;
+}
+
+static bool runSuite()
+{
+	bool passed = true;
+	uint64_t totalNodes = 0;
+	double totalSeconds = 0.0;
+
+	for(auto& entry : suite)
+	{
+		Chess::Game game(8, 8);
+		if(!game.fromFEN(entry.fen))
+		{
+			printf("%-24s invalid FEN\n", entry.name);
+			passed = false;
+			continue;
+		}
+
+		double seconds;
+		overflowed = false;
+		uint64_t nodes = run(game, entry.depth, false, seconds);
+
+		bool ok = nodes == entry.nodes && !overflowed;
+		passed = passed && ok;
+
+		totalNodes += nodes;
+		totalSeconds += seconds;
+
+		printf("%-24s depth %u %12lu %s (expected %lu) %.0f nodes/s\n", entry.name, entry.depth,
+				nodes, ok ? "ok  " : "FAIL", entry.nodes, nodes / seconds);
+	}
+
+	passed = checkSmallBoards() && passed;
+
+	printf("\n%s: %lu nodes in %.3f s, %.0f nodes/s\n", passed ? "Passed" : "Failed",
+			totalNodes, totalSeconds, totalNodes / totalSeconds);
+
+	return passed;
+}
+
+static void usage(const char* name)
+{
+	printf(	"Usage: %s [options]\n"
+			"  -d, --depth N           Count leaf nodes to depth N (default 4)\n"
+			"  -f, --fen FEN           Start from the given FEN or extended FEN\n"
+			"  -s, --size W H          Board size when not using a FEN (default 8 8)\n"
+			"  -p, --players N         Player count when not using a FEN (default 2)\n"
+			"  -D, --divide            Show the node count of each root move\n"
+			"  -S, --suite             Run the built-in suite of known positions\n", name);
+}
+
+int main(int argc, char** argv)
+{
+	unsigned depth = 4;
+	const char* fen = nullptr;
+	Vec2s size(8, 8);
+	size_t playerCount = 2;
+	bool divide = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		auto is = [&](const char* s, const char* l) { return !strcmp(argv[i], s) || !strcmp(argv[i], l); };
+		bool hasValue = i + 1 < argc;
+
+		if(is("-d", "--depth") && hasValue) depth = atoi(argv[++i]);
+		else if(is("-f", "--fen") && hasValue) fen = argv[++i];
+		else if(is("-s", "--size") && i + 2 < argc) { size.x = atoi(argv[++i]); size.y = atoi(argv[++i]); }
+		else if(is("-p", "--players") && hasValue) playerCount = atoi(argv[++i]);
+		else if(is("-D", "--divide")) divide = true;
+		else if(is("-S", "--suite")) return !runSuite();
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	//	Players are placed next to the center so the board needs at least 2 tiles per side
+	if(!fen && (size.x < 2 || size.y < 2 || size.x > Chess::MoveTables::maxSize || size.y > Chess::MoveTables::maxSize))
+	{
+		printf("Board size should be between 2x2 and 16x16\n");
+		return 1;
+	}
+
+	Chess::Game game(size.x, size.y);
+
+	if(fen)
+	{
+		if(!game.fromFEN(fen))
+		{
+			printf("Invalid FEN \"%s\"\n", fen);
+			return 1;
+		}
+	}
+
+	else
+	{
+		//	Place the players the same way as examples/online does
+		size_t centerLeft = size.x / 2 - 1;
+		Vec2s middle(centerLeft, size.y / 2);
+
+		Vec2s positions[]
+		{
+			Vec2s(centerLeft, 0),
+			Vec2s(centerLeft, size.y - 1),
+			Vec2s(0, centerLeft),
+			Vec2s(size.x - 1, centerLeft)
+		};
+
+		if(playerCount < 1 || playerCount > 4)
+		{
+			printf("Player count should be between 1 and 4\n");
+			return 1;
+		}
+
+		for(size_t i = 0; i < playerCount; i++)
+		{
+			//	The pieces of a player take 8 tiles along the edge and 2 tiles inwards
+			if(!game.addPlayer(positions[i], middle, false))
+			{
+				printf("The pieces of player %zu don't fit on a %zux%zu board\n", i + 1, size.x, size.y);
+				return 1;
+			}
+		}
+	}
+
+	//	The extended notation of other layouts can be copied from here
+	printf("FEN: %s\n", game.toFEN().c_str());
+
+	double seconds;
+	uint64_t nodes = run(game, depth, divide, seconds);
+
+	printf("\nNodes: %lu\nTime: %.3f s\nNodes/s: %.0f\n", nodes, seconds, nodes / seconds);
+
+	if(overflowed)
+	{
+		printf("Some positions have more than %zu moves so the count is incomplete\n", Chess::MoveList::capacity);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,156 @@
+#include "../../chess/PGN.hh"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Totals
+{
+	uint64_t games = 0;
+	uint64_t moves = 0;
+	uint64_t failed = 0;
+};
+
+static void usage(const char* name)
+{
+	printf(	"Usage: %s [options] FILE\n"
+			"  -T, --threads N         Replay with N threads (default is the core count)\n"
+			"  -v, --verbose           Print the moves that can't be replayed\n", name);
+}
+
+int main(int argc, char** argv)
+{
+	const char* path = nullptr;
+	unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+	bool verbose = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		auto is = [&](const char* s, const char* l) { return !strcmp(argv[i], s) || !strcmp(argv[i], l); };
+		bool hasValue = i + 1 < argc;
+
+		if(is("-T", "--threads") && hasValue) threadCount = std::max(1, atoi(argv[++i]));
+		else if(is("-v", "--verbose")) verbose = true;
+		else if(argv[i][0] != '-' && !path) path = argv[i];
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if(!path)
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	int file = open(path, O_RDONLY);
+	struct stat info;
+
+	if(file < 0 || fstat(file, &info) < 0)
+	{
+		printf("Can't open %s\n", path);
+		return 1;
+	}
+
+	//	The whole file is mapped so that the reader can point directly to it
+	size_t length = info.st_size;
+	const char* data = nullptr;
+
+	if(length > 0)
+	{
+		void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+		if(mapping == MAP_FAILED)
+		{
+			printf("Can't map %s\n", path);
+			return 1;
+		}
+
+		madvise(mapping, length, MADV_SEQUENTIAL);
+		data = static_cast <const char*> (mapping);
+	}
+
+	close(file);
+
+	std::string_view text(data, length);
+	auto start = std::chrono::steady_clock::now();
+
+	/*	There are more shards than threads so that a thread that gets
+	 *	short games can take another shard while the others are busy */
+	std::vector <std::string_view> shards = Chess::PGNReader::split(text, threadCount * 8);
+	std::atomic <size_t> nextShard { 0 };
+
+	std::vector <Totals> totals(threadCount);
+	std::vector <std::thread> threads;
+	std::mutex printLock;
+
+	for(unsigned i = 0; i < threadCount; i++)
+	{
+		threads.emplace_back([&, i]()
+		{
+			Chess::Game game(8, 8);
+			Chess::PGNGame result;
+			Totals& own = totals[i];
+
+			for(size_t shard = nextShard++; shard < shards.size(); shard = nextShard++)
+			{
+				Chess::PGNReader reader(shards[shard]);
+
+				while(reader.next(game, result))
+				{
+					own.games++;
+					own.moves += result.moves;
+
+					if(!result.failed())
+						continue;
+
+					own.failed++;
+
+					if(verbose)
+					{
+						std::lock_guard <std::mutex> lock(printLock);
+						printf("Can't replay \"%.*s\" at byte %zu\n", static_cast <int> (result.error.size()),
+								result.error.data(), static_cast <size_t> (result.error.data() - data));
+					}
+				}
+			}
+		});
+	}
+
+	for(auto& thread : threads)
+		thread.join();
+
+	double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now() - start).count();
+
+	Totals total;
+	for(auto& t : totals)
+	{
+		total.games += t.games;
+		total.moves += t.moves;
+		total.failed += t.failed;
+	}
+
+	printf("Games: %lu (%lu failed)\nMoves: %lu\nThreads: %u\nTime: %.3f s\n", total.games,
+			total.failed, total.moves, threadCount, seconds);
+
+	if(seconds > 0.0)
+		printf("Games/s: %.0f\nMoves/s: %.0f\n", total.games / seconds, total.moves / seconds);
+
+	if(length > 0)
+		munmap(const_cast <char*> (data), length);
+
+	return total.failed > 0;
+}
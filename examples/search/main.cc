@@ -0,0 +1,223 @@
+#include "../../chess/Game.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+static void printMove(const Chess::Move& move)
+{
+	const char promotions[] = " pbnrqk";
+
+	Vec2s from = move.from();
+	Vec2s to = move.to();
+
+	printf("%c%zu%c%zu", static_cast <char> ('a' + from.x), from.y + 1, static_cast <char> ('a' + to.x), to.y + 1);
+
+	if(move.is(Chess::Move::Promotion))
+		printf("%c", promotions[static_cast <size_t> (move.promotion())]);
+}
+
+static void printResult(const Chess::SearchResult& result)
+{
+	printf("depth %2u score %6d nodes %10lu time %7.3f s %9.0f nodes/s move ", result.depth,
+			result.score, result.nodes, result.seconds, result.nodesPerSecond());
+
+	printMove(result.move);
+	printf("\n");
+}
+
+static Chess::SearchResult analyze(Chess::Game& game, const Chess::SearchLimits& limits)
+{
+	//	Each run gets an empty table so that runs don't help each other
+	Chess::TranspositionTable table;
+	Chess::Search search(table);
+
+	Chess::SearchResult result = search.run(game, limits, printResult);
+	printf("\nBest move ");
+	printMove(result.move);
+	printf("\nNodes: %lu\nTime: %.3f s\nNodes/s: %.0f\n", result.nodes, result.seconds, result.nodesPerSecond());
+	printf("Table hits: %.1f%%\n", result.tableHitRate() * 100.0);
+
+	if(result.threadNodes.size() > 1)
+	{
+		for(size_t i = 0; i < result.threadNodes.size(); i++)
+			printf("Thread %zu: %lu nodes\n", i, result.threadNodes[i]);
+	}
+
+	return result;
+}
+
+static void usage(const char* name)
+{
+	printf(	"Usage: %s [options]\n"
+			"  -d, --depth N           Search at most N plies deep\n"
+			"  -n, --nodes N           Search at most N nodes\n"
+			"  -t, --time MS           Search at most MS milliseconds (default 1000)\n"
+			"  -f, --fen FEN           Start from the given FEN\n"
+			"  -s, --size W H          Board size when not using a FEN (default 8 8)\n"
+			"  -p, --players N         Player count when not using a FEN (default 2)\n"
+			"  -T, --threads N         Search with N threads (default 1)\n"
+			"  -c, --compare           Compare the threads against a single thread\n"
+			"  -P, --play N            Let bots play N moves against each other\n"
+			"  -N, --network FILE      Evaluate positions with the given network\n", name);
+}
+
+int main(int argc, char** argv)
+{
+	Chess::SearchLimits limits;
+	limits.milliseconds = 1000;
+
+	const char* fen = nullptr;
+	const char* networkPath = nullptr;
+	Vec2s size(8, 8);
+	size_t playerCount = 2;
+	unsigned play = 0;
+	bool compare = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		auto is = [&](const char* s, const char* l) { return !strcmp(argv[i], s) || !strcmp(argv[i], l); };
+		bool hasValue = i + 1 < argc;
+
+		if(is("-d", "--depth") && hasValue) limits.depth = atoi(argv[++i]);
+		else if(is("-n", "--nodes") && hasValue) limits.nodes = strtoull(argv[++i], nullptr, 10);
+		else if(is("-t", "--time") && hasValue) limits.milliseconds = atoi(argv[++i]);
+		else if(is("-f", "--fen") && hasValue) fen = argv[++i];
+		else if(is("-s", "--size") && i + 2 < argc) { size.x = atoi(argv[++i]); size.y = atoi(argv[++i]); }
+		else if(is("-p", "--players") && hasValue) playerCount = atoi(argv[++i]);
+		else if(is("-T", "--threads") && hasValue) limits.threads = atoi(argv[++i]);
+		else if(is("-c", "--compare")) compare = true;
+		else if(is("-P", "--play") && hasValue) play = atoi(argv[++i]);
+		else if(is("-N", "--network") && hasValue) networkPath = argv[++i];
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	//	Players are placed next to the center so the board needs at least 2 tiles per side
+	if(!fen && (size.x < 2 || size.y < 2 || size.x > Chess::MoveTables::maxSize || size.y > Chess::MoveTables::maxSize))
+	{
+		printf("Board size should be between 2x2 and 16x16\n");
+		return 1;
+	}
+
+	Chess::Game game(size.x, size.y);
+	Chess::Network network;
+
+	if(networkPath)
+	{
+		if(!network.load(networkPath))
+		{
+			printf("Can't load the network from %s\n", networkPath);
+			return 1;
+		}
+
+		game.setNetwork(&network);
+	}
+
+	if(fen)
+	{
+		if(!game.fromFEN(fen))
+		{
+			printf("Invalid FEN \"%s\"\n", fen);
+			return 1;
+		}
+
+		//	Every player is a bot when they play against each other
+		for(size_t i = 0; i < game.getPlayerCount() && play > 0; i++)
+			game.setBot(i, true);
+	}
+
+	else
+	{
+		//	Place the players the same way as examples/online does
+		size_t centerLeft = size.x / 2 - 1;
+		Vec2s middle(centerLeft, size.y / 2);
+
+		Vec2s positions[]
+		{
+			Vec2s(centerLeft, 0),
+			Vec2s(centerLeft, size.y - 1),
+			Vec2s(0, centerLeft),
+			Vec2s(size.x - 1, centerLeft)
+		};
+
+		if(playerCount < 1 || playerCount > 4)
+		{
+			printf("Player count should be between 1 and 4\n");
+			return 1;
+		}
+
+		//	Every player is a bot when they play against each other
+		for(size_t i = 0; i < playerCount; i++)
+		{
+			//	The pieces of a player take 8 tiles along the edge and 2 tiles inwards
+			if(!game.addPlayer(positions[i], middle, play > 0))
+			{
+				printf("The pieces of player %zu don't fit on a %zux%zu board\n", i + 1, size.x, size.y);
+				return 1;
+			}
+		}
+	}
+
+	if(play == 0)
+	{
+		if(!compare)
+		{
+			analyze(game, limits);
+			return 0;
+		}
+
+		Chess::SearchLimits single = limits;
+		single.threads = 1;
+
+		printf("1 thread\n");
+		Chess::SearchResult base = analyze(game, single);
+
+		printf("\n%u threads\n", limits.threads);
+		Chess::SearchResult result = analyze(game, limits);
+
+		/*	When both searches reach the same depth, the time it took tells the speedup.
+		 *	Otherwise only the nodes per second can be compared */
+		if(result.depth == base.depth && result.seconds > 0.0)
+			printf("\nSpeedup to depth %u: %.2fx\n", result.depth, base.seconds / result.seconds);
+
+		printf("Nodes/s: %.2fx\n", result.nodesPerSecond() / base.nodesPerSecond());
+		return 0;
+	}
+
+	game.setBotLimits(limits);
+	uint64_t totalNodes = 0;
+	double totalSeconds = 0.0;
+
+	for(unsigned i = 0; i < play; i++)
+	{
+		size_t turn = game.getCurrentTurn();
+
+		//	Every player is a bot so this makes a single move
+		game.playBots();
+
+		const Chess::SearchResult& report = game.getBotReport();
+		if(report.move == Chess::Move())
+		{
+			printf("Player %zu has no moves\n", turn);
+			break;
+		}
+
+		printf("Player %zu: ", turn);
+		printResult(report);
+
+		totalNodes += report.nodes;
+		totalSeconds += report.seconds;
+	}
+
+	printf("\nNodes: %lu\nTime: %.3f s\n", totalNodes, totalSeconds);
+
+	if(totalSeconds > 0.0)
+		printf("Nodes/s: %.0f\n", totalNodes / totalSeconds);
+
+	return 0;
+}